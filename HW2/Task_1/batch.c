@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "batch.h"
+#include "bitlife.h"
+#include "grid.h"
+#include "fixed.h"
+
+// Boards are evolved in groups of 64, one per bit of a word.
+#define LANES 64
+
+// batch_job is shared by all workers. Every worker takes the next
+// group of boards from next_group until there are none left, so the
+// workers never wait for each other.
+typedef struct {
+    int rows, cols;
+    long generations;
+    long boards;
+    unsigned int first_seed;
+    int fixed;                  // use the kernel specialized for the size
+    batch_result *results;
+    atomic_long next_group;
+} batch_job;
+
+// Bit-sliced boards: word (i, j) holds cell (i, j) of all 64 boards of
+// a group, board b in bit b. The board is surrounded by a frame of
+// dead cells one word wide, so every cell has all eight neighbours.
+typedef struct {
+    int rows, cols;
+    int stride;                 // cols + 2
+    uint64_t *cells;
+} sliced;
+
+static uint64_t *sliced_row(sliced *S, int i) {
+    return S->cells + (size_t)(i + 1) * S->stride + 1;
+}
+
+static void init_sliced(sliced *S, int rows, int cols) {
+    S->rows = rows;
+    S->cols = cols;
+    S->stride = cols + 2;
+    S->cells = calloc((size_t)(rows + 2) * S->stride, sizeof(uint64_t));
+}
+
+// One generation of every board in the group. A word is evolved from
+// the nine words around it with no shifts at all, and the loop over a
+// row is straight-line code the compiler can vectorize.
+static void evolve_sliced(sliced *from, sliced *to) {
+    for (int i = 0; i < from->rows; i++) {
+        const uint64_t *u = sliced_row(from, i - 1);
+        const uint64_t *m = sliced_row(from, i);
+        const uint64_t *d = sliced_row(from, i + 1);
+        uint64_t *out = sliced_row(to, i);
+
+        for (int j = 0; j < from->cols; j++) {
+            out[j] = life_word(u[j - 1], u[j], u[j + 1], m[j - 1], m[j], m[j + 1],
+                               d[j - 1], d[j], d[j + 1]);
+        }
+    }
+}
+
+// Seeds the boards [first, first + lanes) into S through the scratch
+// grid G; the lanes past the end of the batch stay dead.
+static void seed_group(batch_job *job, sliced *S, grid *G, long first, int lanes) {
+    for (int i = 0; i < S->rows; i++) {
+        memset(sliced_row(S, i), 0, S->cols * sizeof(uint64_t));
+    }
+    for (int b = 0; b < lanes; b++) {
+        unsigned int state = job->first_seed + (unsigned int)(first + b);
+
+        job->results[first + b].seed = state;
+        random_populate_r(G, &state);
+        for (int i = 0; i < S->rows; i++) {
+            uint64_t *row = sliced_row(S, i);
+            for (int j = 0; j < S->cols; j++) {
+                row[j] |= (uint64_t)G->val[i][j] << b;
+            }
+        }
+    }
+}
+
+// Counts the live cells of every lane; only live cells cost anything.
+static void count_group(batch_job *job, sliced *S, long first, int lanes) {
+    long population[LANES] = {0};
+
+    for (int i = 0; i < S->rows; i++) {
+        const uint64_t *row = sliced_row(S, i);
+        for (int j = 0; j < S->cols; j++) {
+            for (uint64_t w = row[j]; w; w &= w - 1) {
+                population[__builtin_ctzll(w)]++;
+            }
+        }
+    }
+    for (int b = 0; b < lanes; b++) {
+        job->results[first + b].population = population[b];
+    }
+}
+
+// A worker keeps its two sliced boards and the scratch grid for the
+// whole batch, so nothing is allocated per board.
+static void *batch_worker(void *arguments) {
+    batch_job *job = (batch_job *)arguments;
+    long groups = (job->boards + LANES - 1) / LANES;
+    sliced cur, next;
+    grid *G = init_grid(job->rows, job->cols);
+
+    init_sliced(&cur, job->rows, job->cols);
+    init_sliced(&next, job->rows, job->cols);
+
+    for (long group = atomic_fetch_add(&job->next_group, 1); group < groups;
+         group = atomic_fetch_add(&job->next_group, 1)) {
+        long first = group * LANES;
+        int lanes = job->boards - first < LANES ? (int)(job->boards - first) : LANES;
+
+        seed_group(job, &cur, G, first, lanes);
+        if (job->fixed) {
+            evolve_fixed_group(cur.cells, job->rows, job->cols, job->generations);
+        } else {
+            for (long g = 0; g < job->generations; g++) {
+                evolve_sliced(&cur, &next);
+                sliced swap = cur;
+                cur = next;
+                next = swap;
+            }
+        }
+        count_group(job, &cur, first, lanes);
+    }
+
+    free(cur.cells);
+    free(next.cells);
+    destroy_grid(G);
+    return NULL;
+}
+
+// Evolves boards independent random boards of rows x cols for the
+// given number of generations. Board k is seeded with first_seed + k
+// through random_populate_r, and its result lands in results[k].
+// Whole groups of 64 boards are handed to the workers, which need no
+// barriers since the boards have nothing to do with each other.
+// With fixed set, sizes that have a compile-time specialized kernel
+// (see fixed.cpp) are evolved by it.
+void run_batch(int rows, int cols, long generations, long boards, unsigned int first_seed,
+               int workers, int fixed, batch_result *results) {
+    batch_job job;
+    pthread_t threads[workers > 0 ? workers : 1];
+    int started = 0;
+
+    job.rows = rows;
+    job.cols = cols;
+    job.generations = generations;
+    job.boards = boards;
+    job.first_seed = first_seed;
+    job.fixed = fixed && fixed_size_supported(rows, cols);
+    job.results = results;
+    atomic_init(&job.next_group, 0);
+
+    for (int t = 0; t < workers; t++) {
+        if (pthread_create(&threads[t], NULL, &batch_worker, &job) != 0) break;
+        started++;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    // Without any worker the batch is still finished here.
+    if (started == 0) {
+        batch_worker(&job);
+    }
+}
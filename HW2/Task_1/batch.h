@@ -0,0 +1,13 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+// The final state of one board of a batch.
+typedef struct {
+    unsigned int seed;
+    long population;
+} batch_result;
+
+void run_batch(int rows, int cols, long generations, long boards, unsigned int first_seed,
+               int workers, int fixed, batch_result *results);
+
+#endif
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Compares the row-band and tiled layouts on the board sizes of data.csv.
+# The tiles column uses the default tile shape; every RxC shape in
+# TILES adds a column of its own.
+# Usage: [TILES="64x1024 ..."] ./bench_layout.sh [GENERATIONS] [THREADS] > layout.csv
+set -e
+
+GENERATIONS=${1:-100}
+THREADS=${2:-4}
+BUILD=${BUILD:-cmake-build-release}
+TILES=${TILES:-}
+
+cmake -S . -B "$BUILD" -DCMAKE_BUILD_TYPE=Release >/dev/null
+cmake --build "$BUILD" >/dev/null
+
+elapsed() {
+    printf "%s\n%s\n%s\n%s\nR\n" "$1" "$1" "$GENERATIONS" "$THREADS" |
+        "$BUILD/Task_1" -f summary -l "$2" ${3:+--tile "$3"} | sed -n 's/.*Elapsed time: \([0-9]*\).*/\1/p'
+}
+
+header="Size;bands;tiles"
+for shape in $TILES; do
+    header="$header;tiles $shape"
+done
+echo "$header"
+for size in 100 1000 5000 10000; do
+    line="$size;$(elapsed $size bands);$(elapsed $size tiles)"
+    for shape in $TILES; do
+        line="$line;$(elapsed $size tiles "$shape")"
+    done
+    echo "$line"
+done
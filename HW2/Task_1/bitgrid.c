@@ -0,0 +1,54 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bitgrid.h"
+
+// Allocates a zeroed packed board of dimensions rows x cols.
+bitgrid *init_bitgrid(int rows, int cols) {
+    bitgrid *B = (bitgrid *)malloc(sizeof(bitgrid));
+    B->rows = rows;
+    B->cols = cols;
+    B->words = BITGRID_WORDS(cols);
+    B->bits = calloc((size_t)rows * B->words, sizeof(uint64_t));
+    return B;
+}
+
+void destroy_bitgrid(bitgrid *B) {
+    free(B->bits);
+    free(B);
+}
+
+// Packs rows [from, to) of G into bits, which is laid out like
+// bitgrid::bits for a board as wide as G. Only the rows in the range
+// are touched, so threads may pack their own sections concurrently.
+void pack_rows(uint64_t *bits, grid *G, int from, int to) {
+    int words = BITGRID_WORDS(G->cols);
+
+    for (int i = from; i < to; i++) {
+        const int *row = G->val[i];
+        uint64_t *dst = bits + (size_t)i * words;
+
+        for (int w = 0; w < words; w++) {
+            int base = w * 64;
+            int n = G->cols - base < 64 ? G->cols - base : 64;
+            uint64_t word = 0;
+            for (int k = 0; k < n; k++) {
+                word |= (uint64_t)(row[base + k] & 1) << k;
+            }
+            dst[w] = word;
+        }
+    }
+}
+
+// The reverse of pack_rows: expands rows [from, to) of bits into G.
+void unpack_rows(grid *G, const uint64_t *bits, int from, int to) {
+    int words = BITGRID_WORDS(G->cols);
+
+    for (int i = from; i < to; i++) {
+        int *row = G->val[i];
+        const uint64_t *src = bits + (size_t)i * words;
+
+        for (int j = 0; j < G->cols; j++) {
+            row[j] = (int)((src[j >> 6] >> (j & 63)) & 1);
+        }
+    }
+}
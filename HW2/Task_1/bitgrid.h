@@ -0,0 +1,24 @@
+#include <stdint.h>
+#include "grid.h"
+
+#ifndef _BITGRID_H
+#define _BITGRID_H
+
+// bitgrid is the packed form of a grid: one bit per cell, each row
+// padded to whole 64-bit words. Cell j of a row lives in bit j % 64
+// of word j / 64; the padding bits are always zero.
+typedef struct {
+    int rows;
+    int cols;
+    int words;              // 64-bit words per row
+    uint64_t *bits;         // rows * words words, row after row
+} bitgrid;
+
+#define BITGRID_WORDS(cols) (((cols) + 63) / 64)
+
+bitgrid *init_bitgrid(int rows, int cols);
+void destroy_bitgrid(bitgrid *B);
+void pack_rows(uint64_t *bits, grid *G, int from, int to);
+void unpack_rows(grid *G, const uint64_t *bits, int from, int to);
+
+#endif
@@ -0,0 +1,37 @@
+#include <stdint.h>
+#include "bitlife.h"
+
+// Word w of a packed row, with everything outside the board
+// (a missing row or a word past either end) reading as dead.
+static inline uint64_t word_at(const uint64_t *row, int w, int words) {
+    return (row && w >= 0 && w < words) ? row[w] : 0;
+}
+
+// Computes the next generation of one packed row (see bitgrid.h for
+// the layout) from the row itself and the rows above and below it;
+// up or down is NULL at the edge of the board. 64 cells are updated
+// at once by life_word.
+void evolve_packed_row(const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+                       uint64_t *out, int cols) {
+    int words = (cols + 63) / 64;
+
+    for (int w = 0; w < words; w++) {
+        uint64_t u = word_at(up, w, words), d = word_at(down, w, words), m = mid[w];
+
+        // Neighbours to the left end up at the cell's own bit by a
+        // left shift, neighbours to the right by a right shift.
+        uint64_t ul = (u << 1) | (word_at(up, w - 1, words) >> 63);
+        uint64_t ur = (u >> 1) | (word_at(up, w + 1, words) << 63);
+        uint64_t dl = (d << 1) | (word_at(down, w - 1, words) >> 63);
+        uint64_t dr = (d >> 1) | (word_at(down, w + 1, words) << 63);
+        uint64_t ml = (m << 1) | (word_at(mid, w - 1, words) >> 63);
+        uint64_t mr = (m >> 1) | (word_at(mid, w + 1, words) << 63);
+
+        out[w] = life_word(ul, u, ur, ml, m, mr, dl, d, dr);
+    }
+
+    // Keep the padding bits behind the last cell clear.
+    if (cols % 64) {
+        out[words - 1] &= (UINT64_C(1) << (cols % 64)) - 1;
+    }
+}
@@ -0,0 +1,34 @@
+#include <stdint.h>
+
+#ifndef _BITLIFE_H
+#define _BITLIFE_H
+
+// Applies the rule to 64 cells at once. Every argument holds one bit
+// per cell: the cells themselves (m) and their eight neighbours, named
+// by the side they are on. The neighbour bits are added with bitwise
+// full adders, so there is no per-cell work at all.
+static inline uint64_t life_word(uint64_t ul, uint64_t u, uint64_t ur,
+                                 uint64_t ml, uint64_t m, uint64_t mr,
+                                 uint64_t dl, uint64_t d, uint64_t dr) {
+    // Row sums: the upper and lower rows add three bits each,
+    // the middle row two.
+    uint64_t us = ul ^ u ^ ur, uc = (ul & u) | (ur & (ul ^ u));
+    uint64_t ds = dl ^ d ^ dr, dc = (dl & d) | (dr & (dl ^ d));
+    uint64_t ms = ml ^ mr, mc = ml & mr;
+
+    // ones is the low bit of the count; the four carries are worth
+    // two each, and the count is 2 or 3 only if exactly one of them
+    // is set.
+    uint64_t ones = us ^ ds ^ ms;
+    uint64_t tc = (us & ds) | (ms & (us ^ ds));
+    uint64_t p1 = uc ^ dc, q1 = uc & dc;
+    uint64_t p2 = mc ^ tc, q2 = mc & tc;
+    uint64_t one_two = (p1 ^ p2) & ~(q1 | q2);
+
+    return one_two & (ones | m);
+}
+
+void evolve_packed_row(const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+                       uint64_t *out, int cols);
+
+#endif
@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+
+static long elapsed_ns(struct timespec *from, struct timespec *to) {
+    return 1000000000L * (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec);
+}
+
+// A cheap 64-bit checksum (multiply-xorshift per word), enough to
+// catch torn or truncated files.
+uint64_t checkpoint_checksum(const uint64_t *words, size_t n) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+    for (size_t i = 0; i < n; i++) {
+        h = (h ^ words[i]) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+static int write_all(int fd, const void *data, size_t n) {
+    const char *p = data;
+    while (n > 0) {
+        ssize_t done = write(fd, p, n);
+        if (done < 0) return -1;
+        p += done;
+        n -= done;
+    }
+    return 0;
+}
+
+// Describes a rows x cols board of the given generation whose packed
+// payload is bits.
+void fill_checkpoint_header(checkpoint_header *header, int rows, int cols, long generation,
+                            const uint64_t *bits) {
+    size_t words = (size_t)rows * BITGRID_WORDS(cols);
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic));
+    header->version = CHECKPOINT_VERSION;
+    header->payload_offset = CHECKPOINT_PAYLOAD_OFFSET;
+    header->rows = rows;
+    header->cols = cols;
+    header->birth = LIFE_BIRTH;
+    header->survive = LIFE_SURVIVE;
+    header->generation = generation;
+    header->payload_size = words * sizeof(uint64_t);
+    header->checksum = checkpoint_checksum(bits, words);
+}
+
+// Writes B as the checkpoint of the given generation. The file is
+// written next to path and renamed over it once it is complete, so
+// a crash never leaves a half-written checkpoint behind.
+int write_checkpoint(const char *path, const bitgrid *B, long generation) {
+    char tmp[4096];
+    char pad[CHECKPOINT_PAYLOAD_OFFSET];
+    checkpoint_header header;
+
+    fill_checkpoint_header(&header, B->rows, B->cols, generation, B->bits);
+    memset(pad, 0, sizeof(pad));
+    memcpy(pad, &header, sizeof(header));
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(tmp);
+        return -1;
+    }
+    if (write_all(fd, pad, sizeof(pad)) != 0 ||
+        write_all(fd, B->bits, header.payload_size) != 0 ||
+        fsync(fd) != 0) {
+        perror(tmp);
+        close(fd);
+        unlink(tmp);
+        return -1;
+    }
+    close(fd);
+
+    if (rename(tmp, path) != 0) {
+        perror(path);
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+// Reads and validates the header of the checkpoint at path.
+// Returns 0 if it describes a usable checkpoint.
+int read_checkpoint_header(const char *path, checkpoint_header *header) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    ssize_t n = read(fd, header, sizeof(*header));
+    close(fd);
+
+    if (n != (ssize_t)sizeof(*header) || memcmp(header->magic, CHECKPOINT_MAGIC, 8) != 0) {
+        fprintf(stderr, "%s is not a checkpoint.\n", path);
+        return -1;
+    }
+    if (header->version != CHECKPOINT_VERSION) {
+        fprintf(stderr, "%s has unsupported checkpoint version %u.\n", path, header->version);
+        return -1;
+    }
+    if (header->birth != LIFE_BIRTH || header->survive != LIFE_SURVIVE) {
+        fprintf(stderr, "%s was not written with rule B3/S23.\n", path);
+        return -1;
+    }
+    if (header->rows <= 0 || header->cols <= 0 ||
+        header->payload_size != (uint64_t)header->rows * BITGRID_WORDS(header->cols) * sizeof(uint64_t)) {
+        fprintf(stderr, "%s has a corrupt header.\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+typedef struct {
+    grid *G;
+    const uint64_t *bits;
+    int from, to;
+} unpack_job;
+
+static void *unpack_func(void *arguments) {
+    unpack_job *job = (unpack_job *)arguments;
+    unpack_rows(job->G, job->bits, job->from, job->to);
+    return NULL;
+}
+
+// Maps the checkpoint at path and expands it into G, which must have
+// the dimensions stored in the header. The payload is read straight
+// from the mapping by the given number of threads.
+int restore_checkpoint(const char *path, grid *G, long *generation, int threads) {
+    checkpoint_header header;
+    if (read_checkpoint_header(path, &header) != 0) return -1;
+    if (header.rows != G->rows || header.cols != G->cols) {
+        fprintf(stderr, "%s holds a %d x %d board.\n", path, header.rows, header.cols);
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 ||
+        (uint64_t)st.st_size < header.payload_offset + header.payload_size) {
+        fprintf(stderr, "%s is truncated.\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+    madvise(data, st.st_size, MADV_WILLNEED);
+
+    const uint64_t *bits = (const uint64_t *)((const char *)data + header.payload_offset);
+    if (checkpoint_checksum(bits, header.payload_size / sizeof(uint64_t)) != header.checksum) {
+        fprintf(stderr, "%s is corrupt (checksum mismatch).\n", path);
+        munmap(data, st.st_size);
+        return -1;
+    }
+
+    if (threads < 1) threads = 1;
+    unpack_job jobs[threads];
+    pthread_t workers[threads];
+    for (int i = 0; i < threads; i++) {
+        jobs[i].G = G;
+        jobs[i].bits = bits;
+        jobs[i].from = (int)((long)G->rows * i / threads);
+        jobs[i].to = (int)((long)G->rows * (i + 1) / threads);
+        pthread_create(&workers[i], NULL, &unpack_func, (void *)&jobs[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    munmap(data, st.st_size);
+    *generation = (long)header.generation;
+    return 0;
+}
+
+// The writer thread: waits for a full staging buffer, takes it over
+// by swapping buffers and writes it out without holding the lock.
+static void *writer_func(void *arguments) {
+    checkpointer *C = (checkpointer *)arguments;
+
+    pthread_mutex_lock(&C->mutex);
+    for (;;) {
+        while (!C->pending && !C->stop) {
+            pthread_cond_wait(&C->cv, &C->mutex);
+        }
+        if (!C->pending) break;
+
+        bitgrid *tmp = C->writing;
+        C->writing = C->staging;
+        C->staging = tmp;
+        C->writing_gen = C->staging_gen;
+        C->pending = 0;
+        pthread_cond_broadcast(&C->cv);
+        pthread_mutex_unlock(&C->mutex);
+
+        int status = write_checkpoint(C->path, C->writing, C->writing_gen);
+
+        pthread_mutex_lock(&C->mutex);
+        if (status == 0) C->written++;
+        else C->failed++;
+    }
+    pthread_mutex_unlock(&C->mutex);
+    return NULL;
+}
+
+// Starts a background checkpoint writer for a rows x cols board that
+// saves every interval generations to path.
+checkpointer *init_checkpointer(const char *path, int interval, int rows, int cols) {
+    checkpointer *C = (checkpointer *)calloc(1, sizeof(checkpointer));
+    C->path = path;
+    C->interval = interval;
+    C->staging = init_bitgrid(rows, cols);
+    C->writing = init_bitgrid(rows, cols);
+    pthread_mutex_init(&C->mutex, NULL);
+    pthread_cond_init(&C->cv, NULL);
+    pthread_create(&C->thread, NULL, &writer_func, (void *)C);
+    return C;
+}
+
+// Waits for the last submitted checkpoint to hit the disk and stops
+// the writer thread. The counters are final afterwards.
+void finish_checkpointer(checkpointer *C) {
+    if (C->stop) return;
+
+    pthread_mutex_lock(&C->mutex);
+    C->stop = 1;
+    pthread_cond_broadcast(&C->cv);
+    pthread_mutex_unlock(&C->mutex);
+    pthread_join(C->thread, NULL);
+}
+
+void destroy_checkpointer(checkpointer *C) {
+    finish_checkpointer(C);
+    pthread_mutex_destroy(&C->mutex);
+    pthread_cond_destroy(&C->cv);
+    destroy_bitgrid(C->staging);
+    destroy_bitgrid(C->writing);
+    free(C);
+}
+
+int checkpoint_due(checkpointer *C, long generation) {
+    return C->interval > 0 && generation % C->interval == 0;
+}
+
+// Called by one thread before the board is packed into the staging
+// buffer. Only blocks if the writer has not yet taken the previous
+// checkpoint, i.e. if checkpoints come faster than the disk.
+void checkpoint_acquire(checkpointer *C) {
+    pthread_mutex_lock(&C->mutex);
+    if (C->pending) {
+        struct timespec t1, t2;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        while (C->pending) {
+            pthread_cond_wait(&C->cv, &C->mutex);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        C->stalls++;
+        C->stall_ns += elapsed_ns(&t1, &t2);
+    }
+    pthread_mutex_unlock(&C->mutex);
+}
+
+// Hands the packed staging buffer over to the writer thread.
+void checkpoint_submit(checkpointer *C, long generation) {
+    pthread_mutex_lock(&C->mutex);
+    C->staging_gen = generation;
+    C->pending = 1;
+    pthread_cond_broadcast(&C->cv);
+    pthread_mutex_unlock(&C->mutex);
+}
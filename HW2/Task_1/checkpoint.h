@@ -0,0 +1,74 @@
+#include <stdint.h>
+#include <pthread.h>
+#include "grid.h"
+#include "bitgrid.h"
+
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H
+
+#define CHECKPOINT_MAGIC "GOLCKPT1"
+#define CHECKPOINT_VERSION 1
+
+// The payload starts on its own page so it can be mapped and read
+// without any realignment.
+#define CHECKPOINT_PAYLOAD_OFFSET 4096
+
+// The rule is stored as two masks: bit n of birth is set if a dead
+// cell with n neighbours is born, bit n of survive if a live one
+// stays alive. Only Conway's B3/S23 is simulated.
+#define LIFE_BIRTH (1u << 3)
+#define LIFE_SURVIVE ((1u << 2) | (1u << 3))
+
+// On-disk header of a checkpoint. It is followed (at payload_offset)
+// by the board packed exactly like bitgrid::bits, little endian.
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t payload_offset;
+    int32_t rows;
+    int32_t cols;
+    uint32_t birth;
+    uint32_t survive;
+    uint64_t generation;
+    uint64_t payload_size;
+    uint64_t checksum;      // of the payload words
+    uint64_t reserved;
+} checkpoint_header;
+
+// checkpointer writes checkpoints in the background. The compute
+// threads pack the board into the staging buffer, and the writer
+// thread swaps it with its own buffer and writes that one out while
+// the simulation goes on.
+typedef struct {
+    const char *path;
+    int interval;               // generations between checkpoints
+    bitgrid *staging;           // being filled by the compute threads
+    bitgrid *writing;           // owned by the writer thread
+    long staging_gen;
+    long writing_gen;
+    int pending;                // staging is full and waits for the writer
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    long written;               // checkpoints on disk
+    long failed;
+    long stalls;                // times the compute threads had to wait
+    long stall_ns;
+} checkpointer;
+
+checkpointer *init_checkpointer(const char *path, int interval, int rows, int cols);
+void finish_checkpointer(checkpointer *C);
+void destroy_checkpointer(checkpointer *C);
+int checkpoint_due(checkpointer *C, long generation);
+void checkpoint_acquire(checkpointer *C);
+void checkpoint_submit(checkpointer *C, long generation);
+
+void fill_checkpoint_header(checkpoint_header *header, int rows, int cols, long generation,
+                            const uint64_t *bits);
+int write_checkpoint(const char *path, const bitgrid *B, long generation);
+int read_checkpoint_header(const char *path, checkpoint_header *header);
+int restore_checkpoint(const char *path, grid *G, long *generation, int threads);
+uint64_t checkpoint_checksum(const uint64_t *words, size_t n);
+
+#endif
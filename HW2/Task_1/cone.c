@@ -0,0 +1,68 @@
+#include <stdlib.h>
+#include <string.h>
+#include "cone.h"
+#include "evolve.h"
+
+// Grows the rectangle by margin cells on every side, without leaving
+// a board of rows x cols.
+static tile widen(tile r, long margin, int rows, int cols) {
+    tile out;
+    out.r0 = r.r0 - margin > 0 ? (int)(r.r0 - margin) : 0;
+    out.c0 = r.c0 - margin > 0 ? (int)(r.c0 - margin) : 0;
+    out.r1 = r.r1 + margin < rows ? (int)(r.r1 + margin) : rows;
+    out.c1 = r.c1 + margin < cols ? (int)(r.c1 + margin) : cols;
+    return out;
+}
+
+// Returns the window of G as it will look after the given number of
+// generations, leaving G untouched. A cell only depends on the cells
+// within one step of it in the previous generation, so the window
+// depends on nothing outside a margin of generations cells around it.
+// Only that cone is copied out of G, and every generation evolves it
+// one cell smaller on each side, until just the window is left. At
+// the edges of the board the cone is cut off, which is exact since
+// the cells beyond the edge stay dead. The result is a new grid of the
+// window's size, NULL if the window does not lie on the board.
+grid *light_cone(grid *G, tile window, long generations) {
+    if (window.r0 < 0 || window.c0 < 0 || window.r1 > G->rows || window.c1 > G->cols ||
+        window.r0 >= window.r1 || window.c0 >= window.c1 || generations < 0) {
+        return NULL;
+    }
+
+    tile cone = widen(window, generations, G->rows, G->cols);
+    int rows = cone.r1 - cone.r0, cols = cone.c1 - cone.c0;
+    grid *cur = init_grid(rows, cols);
+    grid *next = init_grid(rows, cols);
+    int *zeros = calloc(cols, sizeof(int));
+
+    for (int i = 0; i < rows; i++) {
+        memcpy(cur->val[i], G->val[cone.r0 + i] + cone.c0, cols * sizeof(int));
+    }
+
+    // Cells of the cone are moved to the cone's own coordinates.
+    window.r0 -= cone.r0;
+    window.r1 -= cone.r0;
+    window.c0 -= cone.c0;
+    window.c1 -= cone.c0;
+
+    // Only the part that is still exact at generation g is evolved.
+    // It stays one cell inside the part evolved before, except where
+    // it touches the edge of the board, and outside of it next may
+    // hold anything.
+    for (long g = 1; g <= generations; g++) {
+        tile valid = widen(window, generations - g, rows, cols);
+        evolve_rect(cur, next, valid.r0, valid.r1, valid.c0, valid.c1, zeros, NULL);
+        grid *swap = cur;
+        cur = next;
+        next = swap;
+    }
+
+    grid *result = init_grid(window.r1 - window.r0, window.c1 - window.c0);
+    for (int i = 0; i < result->rows; i++) {
+        memcpy(result->val[i], cur->val[window.r0 + i] + window.c0, result->cols * sizeof(int));
+    }
+    destroy_grid(cur);
+    destroy_grid(next);
+    free(zeros);
+    return result;
+}
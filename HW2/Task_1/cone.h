@@ -0,0 +1,9 @@
+#include "grid.h"
+#include "tiling.h"
+
+#ifndef _CONE_H
+#define _CONE_H
+
+grid *light_cone(grid *G, tile window, long generations);
+
+#endif
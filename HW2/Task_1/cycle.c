@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include "cycle.h"
+
+// uint64_t slots per thread in band_hash, one cache line.
+#define SLOT 8
+
+cycle_detector *init_cycle_detector(int threads, int window, cycle_action action) {
+    cycle_detector *D = (cycle_detector *)calloc(1, sizeof(cycle_detector));
+    D->threads = threads;
+    D->window = window;
+    D->action = action;
+    D->band_hash = calloc((size_t)threads * SLOT, sizeof(uint64_t));
+    D->history = calloc((size_t)threads * window, sizeof(uint64_t));
+    D->seen = calloc(threads, sizeof(long));
+    return D;
+}
+
+void destroy_cycle_detector(cycle_detector *D) {
+    free(D->band_hash);
+    free(D->history);
+    free(D->seen);
+    free(D);
+}
+
+// Hashes rows [from, to) of G. Every row is hashed on its own, keyed
+// by its index, and the row hashes are combined with xor, so the
+// hashes of separate sections simply xor into the hash of the board.
+uint64_t hash_rows(grid *G, int from, int to) {
+    uint64_t board = 0;
+
+    for (int i = from; i < to; i++) {
+        const int *row = G->val[i];
+        uint64_t h = 0x9e3779b97f4a7c15ULL * (uint64_t)(i + 1);
+
+        for (int base = 0; base < G->cols; base += 64) {
+            int n = G->cols - base < 64 ? G->cols - base : 64;
+            uint64_t word = 0;
+            for (int k = 0; k < n; k++) {
+                word |= (uint64_t)(row[base + k] & 1) << k;
+            }
+            h = (h ^ word) * 0xff51afd7ed558ccdULL;
+            h ^= h >> 29;
+        }
+        board ^= h;
+    }
+    return board;
+}
+
+// Publishes the hash of one thread's section. Must be followed by a
+// barrier before anybody calls cycle_check.
+void cycle_store(cycle_detector *D, int section, uint64_t band_hash) {
+    D->band_hash[section * SLOT] = band_hash;
+}
+
+// Combines the section hashes of the given generation and compares the
+// board against the remembered generations. Returns the generation the
+// run should end at: last if nothing repeats yet, otherwise either the
+// current generation (CYCLE_STOP) or the generation of the coming
+// period whose board is identical to the board at last (CYCLE_JUMP).
+long cycle_check(cycle_detector *D, int section, long generation, long last) {
+    uint64_t hash = 0;
+    for (int t = 0; t < D->threads; t++) {
+        hash ^= D->band_hash[t * SLOT];
+    }
+
+    uint64_t *history = D->history + (size_t)section * D->window;
+    long seen = D->seen[section];
+    long period = 0;
+
+    for (long p = 1; p <= D->window && p <= seen; p++) {
+        if (history[(seen - p) % D->window] == hash) {
+            period = p;
+            break;
+        }
+    }
+    history[seen % D->window] = hash;
+    D->seen[section] = seen + 1;
+
+    if (period == 0) return last;
+
+    if (section == 0 && D->period == 0) {
+        D->period = period;
+        D->onset = generation - period;
+        D->detected = generation;
+    }
+    if (D->action == CYCLE_STOP) return generation;
+
+    // The board at last is the one (last - generation) mod period
+    // generations after the current one.
+    return generation + (last - generation) % period;
+}
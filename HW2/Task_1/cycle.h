@@ -0,0 +1,36 @@
+#include <stdint.h>
+#include "grid.h"
+
+#ifndef _CYCLE_H
+#define _CYCLE_H
+
+// What to do once the board is found to repeat itself.
+typedef enum {
+    CYCLE_STOP,                 // stop right at the first repetition
+    CYCLE_JUMP                  // skip ahead to the requested generation
+} cycle_action;
+
+// cycle_detector hashes the board every generation and remembers
+// the last window hashes. Each thread hashes its own section into
+// band_hash; after the barrier every thread combines the bands and
+// runs the same check on its own copy of the history, so all of them
+// reach the same decision without another barrier.
+typedef struct {
+    int threads;
+    int window;
+    cycle_action action;
+    uint64_t *band_hash;        // one cache line per thread
+    uint64_t *history;          // window hashes per thread
+    long *seen;                 // hashes recorded so far, per thread
+    long period;                // 0 until a repetition is found
+    long onset;                 // first generation of the cycle
+    long detected;              // generation the repetition was seen at
+} cycle_detector;
+
+cycle_detector *init_cycle_detector(int threads, int window, cycle_action action);
+void destroy_cycle_detector(cycle_detector *D);
+uint64_t hash_rows(grid *G, int from, int to);
+void cycle_store(cycle_detector *D, int section, uint64_t band_hash);
+long cycle_check(cycle_detector *D, int section, long generation, long last);
+
+#endif
@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include "dataflow.h"
+#include "evolve.h"
+
+// A worker of one run, with its own deque.
+typedef struct {
+    dataflow *flow;
+    int id;
+} df_worker;
+
+static void push_task(df_deque *Q, df_task task) {
+    pthread_mutex_lock(&Q->lock);
+    Q->tasks[Q->bottom % Q->capacity] = task;
+    Q->bottom++;
+    pthread_mutex_unlock(&Q->lock);
+}
+
+// The owner takes the newest task, which is next to the one it just
+// ran and likely still in cache.
+static int pop_task(df_deque *Q, df_task *task) {
+    int found = 0;
+    pthread_mutex_lock(&Q->lock);
+    if (Q->bottom > Q->top) {
+        Q->bottom--;
+        *task = Q->tasks[Q->bottom % Q->capacity];
+        found = 1;
+    }
+    pthread_mutex_unlock(&Q->lock);
+    return found;
+}
+
+// Thieves take the oldest task.
+static int steal_task(df_deque *Q, df_task *task) {
+    int found = 0;
+    if (pthread_mutex_trylock(&Q->lock) != 0) return 0;
+    if (Q->bottom > Q->top) {
+        *task = Q->tasks[Q->top % Q->capacity];
+        Q->top++;
+        found = 1;
+    }
+    pthread_mutex_unlock(&Q->lock);
+    return found;
+}
+
+// Tile t can run generation g once t and all its neighbours are done
+// with g - 1.
+static int ready(dataflow *D, int t, long g) {
+    int a = t / D->across, b = t % D->across;
+
+    if (g > D->target) return 0;
+    for (int i = a - 1; i <= a + 1; i++) {
+        for (int j = b - 1; j <= b + 1; j++) {
+            if (i < 0 || j < 0 || i >= D->down || j >= D->across) continue;
+            if (atomic_load(&D->done[i * D->across + j]) < g - 1) return 0;
+        }
+    }
+    return 1;
+}
+
+// Hands the next generation of tile t to deque Q if it is ready. The
+// compare-and-swap on queued makes sure only one of the neighbours
+// that finish at the same time does it.
+static void offer(dataflow *D, df_deque *Q, int t) {
+    long last = atomic_load(&D->done[t]);
+
+    if (!ready(D, t, last + 1)) return;
+    if (atomic_compare_exchange_strong(&D->queued[t], &last, last + 1)) {
+        df_task task = {t, last + 1};
+        push_task(Q, task);
+    }
+}
+
+static void run_task(dataflow *D, df_worker *W, df_task task) {
+    const tile *T = &D->tiles[task.tile];
+    int a = task.tile / D->across, b = task.tile % D->across;
+
+    evolve_rect(D->grids[(task.generation - 1) % 2], D->grids[task.generation % 2],
+                T->r0, T->r1, T->c0, T->c1, D->zeros, NULL);
+    atomic_store(&D->done[task.tile], task.generation);
+    atomic_fetch_sub(&D->remaining, 1);
+
+    // Finishing this task may have made the tile itself or any of its
+    // neighbours ready for their next generation.
+    for (int i = a - 1; i <= a + 1; i++) {
+        for (int j = b - 1; j <= b + 1; j++) {
+            if (i < 0 || j < 0 || i >= D->down || j >= D->across) continue;
+            offer(D, &D->deques[W->id], i * D->across + j);
+        }
+    }
+}
+
+static void *df_thread(void *arguments) {
+    df_worker *W = (df_worker *)arguments;
+    dataflow *D = W->flow;
+    df_task task;
+
+    while (atomic_load(&D->remaining) > 0) {
+        if (pop_task(&D->deques[W->id], &task)) {
+            run_task(D, W, task);
+            continue;
+        }
+        int stolen = 0;
+        for (int k = 1; k < D->threads && !stolen; k++) {
+            stolen = steal_task(&D->deques[(W->id + k) % D->threads], &task);
+        }
+        if (stolen) {
+            atomic_fetch_add(&D->steals, 1);
+            run_task(D, W, task);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Picks a tile shape from the caches (see tiling.c), made smaller until
+// there are a few tiles per thread to balance and steal.
+static void pick_shape(dataflow *D, int rows, int cols) {
+    int tile_rows, tile_cols;
+
+    default_tile_shape(&tile_rows, &tile_cols);
+    if (tile_rows > rows) tile_rows = rows;
+    if (tile_cols > cols) tile_cols = cols;
+    while ((long)((rows + tile_rows - 1) / tile_rows) * ((cols + tile_cols - 1) / tile_cols) < 4L * D->threads &&
+           (tile_rows > 8 || tile_cols > 64)) {
+        if (tile_rows > 8 && (tile_rows >= tile_cols / 8 || tile_cols <= 64)) {
+            tile_rows = (tile_rows + 1) / 2;
+        } else {
+            tile_cols = (tile_cols + 1) / 2;
+        }
+    }
+    D->tile_rows = tile_rows;
+    D->tile_cols = tile_cols;
+    D->down = (rows + tile_rows - 1) / tile_rows;
+    D->across = (cols + tile_cols - 1) / tile_cols;
+}
+
+// Sets up a dataflow run of threads workers on a copy of G.
+dataflow *init_dataflow(grid *G, int threads) {
+    dataflow *D = malloc(sizeof(dataflow));
+    int count;
+
+    D->threads = threads < 1 ? 1 : threads;
+    pick_shape(D, G->rows, G->cols);
+    count = D->down * D->across;
+
+    for (int k = 0; k < 2; k++) {
+        D->grids[k] = init_grid(G->rows, G->cols);
+        for (int i = 0; i < G->rows; i++) {
+            memcpy(D->grids[k]->val[i], G->val[i], G->cols * sizeof(int));
+        }
+    }
+    D->zeros = calloc(G->cols, sizeof(int));
+    D->tiles = malloc(count * sizeof(tile));
+    D->done = malloc(count * sizeof(atomic_long));
+    D->queued = malloc(count * sizeof(atomic_long));
+    for (int t = 0; t < count; t++) {
+        int a = t / D->across, b = t % D->across;
+        D->tiles[t].r0 = a * D->tile_rows;
+        D->tiles[t].r1 = (a + 1) * D->tile_rows < G->rows ? (a + 1) * D->tile_rows : G->rows;
+        D->tiles[t].c0 = b * D->tile_cols;
+        D->tiles[t].c1 = (b + 1) * D->tile_cols < G->cols ? (b + 1) * D->tile_cols : G->cols;
+    }
+    D->deques = malloc(D->threads * sizeof(df_deque));
+    for (int w = 0; w < D->threads; w++) {
+        pthread_mutex_init(&D->deques[w].lock, NULL);
+        D->deques[w].capacity = count;
+        D->deques[w].tasks = malloc(count * sizeof(df_task));
+    }
+    D->generation = 0;
+    atomic_init(&D->steals, 0);
+    return D;
+}
+
+// Evolves the board by the given number of generations. Each run
+// starts with every tile at the same generation and ends the same way;
+// in between there are no barriers at all.
+void run_dataflow(dataflow *D, long generations) {
+    int count = D->down * D->across;
+    pthread_t threads[D->threads];
+    df_worker workers[D->threads];
+
+    if (generations <= 0) return;
+
+    // Generations are counted from 0 in every run, which keeps the
+    // parity of the grids right as long as the board starts in grids[0].
+    D->target = generations;
+    atomic_init(&D->remaining, (long)count * generations);
+    for (int t = 0; t < count; t++) {
+        atomic_init(&D->done[t], 0);
+        atomic_init(&D->queued[t], 1);
+    }
+    for (int w = 0; w < D->threads; w++) {
+        D->deques[w].top = D->deques[w].bottom = 0;
+    }
+    // The first generation of every tile is ready; the tiles are dealt
+    // out in blocks so each worker starts on a compact part of the board.
+    for (int t = 0; t < count; t++) {
+        df_task task = {t, 1};
+        push_task(&D->deques[(long)t * D->threads / count], task);
+    }
+
+    for (int w = 0; w < D->threads; w++) {
+        workers[w].flow = D;
+        workers[w].id = w;
+    }
+    for (int w = 1; w < D->threads; w++) {
+        pthread_create(&threads[w], NULL, &df_thread, &workers[w]);
+    }
+    df_thread(&workers[0]);
+    for (int w = 1; w < D->threads; w++) {
+        pthread_join(threads[w], NULL);
+    }
+
+    if (generations % 2) {
+        grid *swap = D->grids[0];
+        D->grids[0] = D->grids[1];
+        D->grids[1] = swap;
+    }
+    D->generation += generations;
+}
+
+// The board at the current generation.
+grid *dataflow_grid(dataflow *D) {
+    return D->grids[0];
+}
+
+void destroy_dataflow(dataflow *D) {
+    for (int w = 0; w < D->threads; w++) {
+        pthread_mutex_destroy(&D->deques[w].lock);
+        free(D->deques[w].tasks);
+    }
+    free(D->deques);
+    free(D->tiles);
+    free(D->zeros);
+    free((void *)D->done);
+    free((void *)D->queued);
+    destroy_grid(D->grids[0]);
+    destroy_grid(D->grids[1]);
+    free(D);
+}
@@ -0,0 +1,52 @@
+#include <stdatomic.h>
+#include <pthread.h>
+#include "grid.h"
+#include "tiling.h"
+
+#ifndef _DATAFLOW_H
+#define _DATAFLOW_H
+
+// A task: one tile at one generation.
+typedef struct {
+    int tile;
+    long generation;
+} df_task;
+
+// Every worker owns a deque of ready tasks. The owner pushes and pops
+// at the bottom, idle workers steal from the top.
+typedef struct {
+    pthread_mutex_t lock;
+    df_task *tasks;             // ring of capacity tasks
+    int capacity;
+    long top, bottom;
+} df_deque;
+
+// dataflow evolves a board without barriers. The board is cut into a
+// regular grid of tiles, and tile t at generation g can run as soon as
+// t and its eight neighbours have reached generation g - 1, so parts of
+// the board drift apart in generation while others are still behind.
+// Two grids are enough: generation g goes to grids[g % 2], and by the
+// time tile t writes there, every neighbour has finished generation
+// g - 1, the last one to read what is overwritten.
+typedef struct {
+    grid *grids[2];
+    int *zeros;                 // a dead row for the tiles at the edges
+    int tile_rows, tile_cols;   // tile shape
+    int across, down;           // tiles per row and column of tiles
+    tile *tiles;
+    atomic_long *done;          // last generation finished, per tile
+    atomic_long *queued;        // last generation handed to a deque, per tile
+    int threads;
+    df_deque *deques;
+    long generation;            // generation of the whole board
+    long target;                // generation the current run stops at
+    atomic_long remaining;      // tasks of the current run not finished
+    atomic_long steals;
+} dataflow;
+
+dataflow *init_dataflow(grid *G, int threads);
+void run_dataflow(dataflow *D, long generations);
+grid *dataflow_grid(dataflow *D);
+void destroy_dataflow(dataflow *D);
+
+#endif
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "bitgrid.h"
+#include "bitlife.h"
+#include "gol.h"
+#include "dataflow.h"
+
+static engine *new_engine(grid *G, int threads, void *state) {
+    engine *E = malloc(sizeof(engine));
+    E->rows = G->rows;
+    E->cols = G->cols;
+    E->threads = threads;
+    E->generation = 0;
+    E->state = state;
+    return E;
+}
+
+static void copy_grid(grid *to, grid *from) {
+    for (int i = 0; i < from->rows; i++) {
+        memcpy(to->val[i], from->val[i], from->cols * sizeof(int));
+    }
+}
+
+// naive: the original evolve, nine reads per cell through
+// count_neighbors. Slow, but it is what every other engine has to
+// agree with.
+
+typedef struct {
+    grid *cur, *next;
+    long births, deaths;        // in the last generation stepped
+} naive_state;
+
+static engine *naive_create(grid *G, int threads) {
+    naive_state *S = malloc(sizeof(naive_state));
+    S->cur = init_grid(G->rows, G->cols);
+    S->next = init_grid(G->rows, G->cols);
+    copy_grid(S->cur, G);
+    S->births = 0;
+    S->deaths = 0;
+    (void)threads;
+    return new_engine(G, 1, S);
+}
+
+static int naive_step(engine *E, long generations) {
+    naive_state *S = E->state;
+
+    for (long g = 0; g < generations; g++) {
+        S->births = 0;
+        S->deaths = 0;
+        for (int i = 0; i < E->rows; i++) {
+            for (int j = 0; j < E->cols; j++) {
+                int neighbors = count_neighbors(S->cur, i, j);
+                int alive = S->cur->val[i][j];
+                int next = neighbors == 3 || (alive && neighbors == 2);
+                S->next->val[i][j] = next;
+                S->births += next && !alive;
+                S->deaths += alive && !next;
+            }
+        }
+        grid *swap = S->cur;
+        S->cur = S->next;
+        S->next = swap;
+    }
+    return 0;
+}
+
+static void naive_export(engine *E, grid *G) {
+    copy_grid(G, ((naive_state *)E->state)->cur);
+}
+
+static void naive_stats(engine *E, gen_stats *stats) {
+    naive_state *S = E->state;
+    grid_stats(S->cur, stats);
+    stats->births = S->births;
+    stats->deaths = S->deaths;
+}
+
+static void naive_destroy(engine *E) {
+    naive_state *S = E->state;
+    destroy_grid(S->cur);
+    destroy_grid(S->next);
+    free(S);
+}
+
+// sliding: evolve's column-sum kernel on the row sections of a gol
+// board, whose worker pool stays up between steps.
+
+static engine *sliding_create(grid *G, int threads) {
+    gol_board *B = gol_create(G->rows, G->cols, threads);
+    if (B == NULL) return NULL;
+    for (int i = 0; i < G->rows; i++) {
+        for (int j = 0; j < G->cols; j++) {
+            gol_set(B, i, j, G->val[i][j]);
+        }
+    }
+    return new_engine(G, threads, B);
+}
+
+static int sliding_step(engine *E, long generations) {
+    gol_step(E->state, generations);
+    return 0;
+}
+
+static void sliding_export(engine *E, grid *G) {
+    unsigned char *row = malloc(E->cols);
+    for (int i = 0; i < E->rows; i++) {
+        gol_read(E->state, i, 0, 1, E->cols, row);
+        for (int j = 0; j < E->cols; j++) {
+            G->val[i][j] = row[j];
+        }
+    }
+    free(row);
+}
+
+static void sliding_destroy(engine *E) {
+    gol_destroy(E->state);
+}
+
+// bitpacked: one bit per cell, 64 cells per full-adder pass
+// (bitlife.c), one thread.
+
+typedef struct {
+    bitgrid *cur, *next;
+} bitpacked_state;
+
+static engine *bitpacked_create(grid *G, int threads) {
+    bitpacked_state *S = malloc(sizeof(bitpacked_state));
+    S->cur = init_bitgrid(G->rows, G->cols);
+    S->next = init_bitgrid(G->rows, G->cols);
+    pack_rows(S->cur->bits, G, 0, G->rows);
+    (void)threads;
+    return new_engine(G, 1, S);
+}
+
+static int bitpacked_step(engine *E, long generations) {
+    bitpacked_state *S = E->state;
+    int words = S->cur->words;
+
+    for (long g = 0; g < generations; g++) {
+        for (int i = 0; i < E->rows; i++) {
+            const uint64_t *mid = S->cur->bits + (size_t)i * words;
+            evolve_packed_row(i > 0 ? mid - words : NULL, mid,
+                              i + 1 < E->rows ? mid + words : NULL,
+                              S->next->bits + (size_t)i * words, E->cols);
+        }
+        bitgrid *swap = S->cur;
+        S->cur = S->next;
+        S->next = swap;
+    }
+    return 0;
+}
+
+static void bitpacked_export(engine *E, grid *G) {
+    unpack_rows(G, ((bitpacked_state *)E->state)->cur->bits, 0, E->rows);
+}
+
+static void bitpacked_destroy(engine *E) {
+    bitpacked_state *S = E->state;
+    destroy_bitgrid(S->cur);
+    destroy_bitgrid(S->next);
+    free(S);
+}
+
+// dataflow: tiles at their own pace on a work-stealing pool, no
+// barriers between generations (dataflow.c).
+
+static engine *dataflow_create(grid *G, int threads) {
+    return new_engine(G, threads, init_dataflow(G, threads));
+}
+
+static int dataflow_step(engine *E, long generations) {
+    run_dataflow(E->state, generations);
+    return 0;
+}
+
+static void dataflow_export(engine *E, grid *G) {
+    copy_grid(G, dataflow_grid(E->state));
+}
+
+static void dataflow_stats(engine *E, gen_stats *stats) {
+    grid_stats(dataflow_grid(E->state), stats);
+}
+
+static void dataflow_destroy(engine *E) {
+    destroy_dataflow(E->state);
+}
+
+static const engine_ops engines[] = {
+    {REFERENCE_ENGINE, naive_create, naive_step, naive_export, naive_stats, naive_destroy},
+    {"sliding", sliding_create, sliding_step, sliding_export, NULL, sliding_destroy},
+    {"bitpacked", bitpacked_create, bitpacked_step, bitpacked_export, NULL, bitpacked_destroy},
+    {"dataflow", dataflow_create, dataflow_step, dataflow_export, dataflow_stats, dataflow_destroy},
+};
+
+// Looks an engine up by name, NULL if there is none.
+const engine_ops *find_engine(const char *name) {
+    for (size_t i = 0; i < sizeof(engines) / sizeof(engines[0]); i++) {
+        if (strcmp(engines[i].name, name) == 0) return &engines[i];
+    }
+    return NULL;
+}
+
+// The engines in registry order, NULL past the last one.
+const engine_ops *engine_at(int index) {
+    if (index < 0 || (size_t)index >= sizeof(engines) / sizeof(engines[0])) return NULL;
+    return &engines[index];
+}
+
+// Starts an engine on a copy of G. If the engine cannot start, the
+// reference engine takes over, so a run never depends on one engine.
+engine *create_engine(const engine_ops *ops, grid *G, int threads) {
+    engine *E = ops->create(G, threads);
+    if (E == NULL && ops != find_engine(REFERENCE_ENGINE)) {
+        fprintf(stderr, "Engine '%s' failed to start, falling back to '%s'.\n", ops->name, REFERENCE_ENGINE);
+        ops = find_engine(REFERENCE_ENGINE);
+        E = ops->create(G, threads);
+    }
+    if (E != NULL) E->ops = ops;
+    return E;
+}
+
+// Evolves the board by the given number of generations. An engine
+// whose step fails has to leave the board at the generation it started
+// from; the reference engine then takes over from there and redoes the
+// step.
+int engine_step(engine *E, long generations) {
+    const engine_ops *reference = find_engine(REFERENCE_ENGINE);
+
+    if (generations <= 0) return 0;
+    if (E->ops->step(E, generations) != 0) {
+        if (E->ops == reference) return -1;
+        fprintf(stderr, "Engine '%s' failed at generation %ld, falling back to '%s'.\n",
+                E->ops->name, E->generation, REFERENCE_ENGINE);
+
+        grid *G = init_grid(E->rows, E->cols);
+        E->ops->export_state(E, G);
+        E->ops->destroy(E);
+        engine *R = reference->create(G, E->threads);
+        destroy_grid(G);
+        E->state = R->state;
+        E->ops = reference;
+        free(R);
+        if (E->ops->step(E, generations) != 0) return -1;
+    }
+    E->generation += generations;
+    return 0;
+}
+
+void engine_export(engine *E, grid *G) {
+    E->ops->export_state(E, G);
+}
+
+// The statistics of the current generation. Births and deaths (of the
+// last generation stepped) are only counted by the reference engine;
+// the faster engines never compare a cell with its old state one by
+// one, so they leave them at zero.
+void engine_stats(engine *E, gen_stats *stats) {
+    if (E->ops->stats) {
+        E->ops->stats(E, stats);
+        return;
+    }
+    grid *G = init_grid(E->rows, E->cols);
+    E->ops->export_state(E, G);
+    grid_stats(G, stats);
+    destroy_grid(G);
+}
+
+void destroy_engine(engine *E) {
+    E->ops->destroy(E);
+    free(E);
+}
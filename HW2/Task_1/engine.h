@@ -0,0 +1,44 @@
+#include "grid.h"
+#include "evolve.h"
+
+#ifndef _ENGINE_H
+#define _ENGINE_H
+
+typedef struct engine engine;
+
+// engine_ops is one way of evolving a board. An engine takes its
+// starting position from a grid, steps it, and hands the board back as
+// a grid; how the board is kept in between is up to the engine. New
+// engines only have to provide these operations and an entry in the
+// registry (engine.c). step returns 0, or -1 with the board left at
+// the generation it started from. stats may be NULL, then the board is
+// exported and counted.
+typedef struct {
+    const char *name;
+    engine *(*create)(grid *G, int threads);
+    int (*step)(engine *E, long generations);
+    void (*export_state)(engine *E, grid *G);
+    void (*stats)(engine *E, gen_stats *stats);
+    void (*destroy)(engine *E);
+} engine_ops;
+
+struct engine {
+    const engine_ops *ops;
+    int rows, cols;
+    int threads;
+    long generation;
+    void *state;                // engine specific data
+};
+
+// The reference engine: count_neighbors for every cell, one thread.
+#define REFERENCE_ENGINE "naive"
+
+const engine_ops *find_engine(const char *name);
+const engine_ops *engine_at(int index);
+engine *create_engine(const engine_ops *ops, grid *G, int threads);
+int engine_step(engine *E, long generations);
+void engine_export(engine *E, grid *G);
+void engine_stats(engine *E, gen_stats *stats);
+void destroy_engine(engine *E);
+
+#endif
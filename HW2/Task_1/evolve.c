@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "evolve.h"
+
+// Resets stats to an empty generation.
+void clear_stats(gen_stats *stats) {
+    stats->population = 0;
+    stats->births = 0;
+    stats->deaths = 0;
+    stats->min_row = stats->min_col = 0x7fffffff;
+    stats->max_row = stats->max_col = -1;
+}
+
+// Grows the bounding box by the live cells first..last of a row,
+// first is negative if the row is empty.
+static void track_row(gen_stats *stats, int row, int first, int last) {
+    if (first < 0) return;
+    if (row < stats->min_row) stats->min_row = row;
+    if (row > stats->max_row) stats->max_row = row;
+    if (first < stats->min_col) stats->min_col = first;
+    if (last > stats->max_col) stats->max_col = last;
+}
+
+// Adds the numbers of another section to into.
+void merge_stats(gen_stats *into, const gen_stats *from) {
+    into->population += from->population;
+    into->births += from->births;
+    into->deaths += from->deaths;
+    if (from->min_row < into->min_row) into->min_row = from->min_row;
+    if (from->max_row > into->max_row) into->max_row = from->max_row;
+    if (from->min_col < into->min_col) into->min_col = from->min_col;
+    if (from->max_col > into->max_col) into->max_col = from->max_col;
+}
+
+// Collects the population and bounding box of a whole board. Only
+// meant for the starting position, later generations get their
+// numbers from evolve.
+void grid_stats(grid *G, gen_stats *stats) {
+    clear_stats(stats);
+    for (int i = 0; i < G->rows; i++) {
+        int first = -1, last = -1;
+        for (int j = 0; j < G->cols; j++) {
+            if (G->val[i][j]) {
+                stats->population++;
+                if (first < 0) first = j;
+                last = j;
+            }
+        }
+        track_row(stats, i, first, last);
+    }
+}
+
+// This function counts the neighbors of a point in our grid.
+int count_neighbors(grid *G, int x, int y) {
+    int i, j, count = 0;
+    for (i = x - 1; i <= x + 1; i++) {
+        for (j = y - 1;j <= y + 1; j++) {
+            if ((i == x && j == y) || (i < 0 || j < 0) || (i >= G->rows || j >= G->cols)) {
+                continue;
+            }
+            if(G->val[i][j] == 1) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+
+// Evolves columns [c0, c1) of the row mid into out. up and down are
+// the rows above and below (a row of zeros at the board edge). Instead
+// of calling count_neighbors for every cell, the kernel keeps the sums
+// of the three vertical cells to the left, at and to the right of the
+// current column and slides that window along the row, so every cell
+// is loaded about three times and the rule is decided without branches.
+// The window sum includes the cell itself: it lives on with 3, or with
+// 4 if it was alive already.
+static void evolve_row(const int *up, const int *mid, const int *down, int *out,
+                       int row, int c0, int c1, int cols, gen_stats *stats) {
+    int left = c0 > 0 ? up[c0 - 1] + mid[c0 - 1] + down[c0 - 1] : 0;
+    int centre = up[c0] + mid[c0] + down[c0];
+    int end = c1 < cols ? c1 : cols - 1;
+    long population = 0, births = 0, deaths = 0;
+    int first = -1, last = -1, j;
+
+    for (j = c0; j < end; j++) {
+        int right = up[j + 1] + mid[j + 1] + down[j + 1];
+        int sum = left + centre + right;
+        int alive = mid[j];
+        int next = (sum == 3) | ((sum == 4) & alive);
+
+        out[j] = next;
+        population += next;
+        births += next & !alive;
+        deaths += alive & !next;
+        first = (first < 0 && next) ? j : first;
+        last = next ? j : last;
+        left = centre;
+        centre = right;
+    }
+    // The last column of the board has nothing on its right.
+    if (j < c1) {
+        int sum = left + centre;
+        int alive = mid[j];
+        int next = (sum == 3) | ((sum == 4) & alive);
+
+        out[j] = next;
+        population += next;
+        births += next & !alive;
+        deaths += alive & !next;
+        first = (first < 0 && next) ? j : first;
+        last = next ? j : last;
+    }
+
+    stats->population += population;
+    stats->births += births;
+    stats->deaths += deaths;
+    track_row(stats, row, first, last);
+}
+
+// evolve_rect looks at the rectangle rows [r0, r1) x columns [c0, c1)
+// of the main grid, and passes the next generation of it to temp grid.
+// zeros is a row of main->cols dead cells standing in for the rows
+// outside the board; it is only read, so threads may share it.
+// If stats is not NULL, the population, births, deaths and bounding box
+// of the new rectangle are collected on the way, so nobody has to scan
+// the board for them afterwards.
+void evolve_rect(grid *main, grid *temp, int r0, int r1, int c0, int c1, const int *zeros,
+                 gen_stats *stats) {
+    gen_stats local;
+
+    clear_stats(&local);
+    if (r0 >= r1 || c0 >= c1) {
+        if (stats) *stats = local;
+        return;
+    }
+
+    for (int i = r0; i < r1; i++) {
+        const int *up = i > 0 ? main->val[i - 1] : zeros;
+        const int *down = i + 1 < main->rows ? main->val[i + 1] : zeros;
+        evolve_row(up, main->val[i], down, temp->val[i], i, c0, c1, main->cols, &local);
+    }
+
+    if (stats) *stats = local;
+}
+
+// evolve function evolves a full-width section of the main grid
+// (height rows starting at part) into temp grid.
+void evolve(grid *main, grid *temp, int height, int part, const int *zeros, gen_stats *stats) {
+    evolve_rect(main, temp, part, part + height, 0, main->cols, zeros, stats);
+}
+
+// Evolves the tiles [first, end) of a tiling one after another and
+// adds their statistics up in stats (if not NULL).
+void evolve_tiles(grid *main, grid *temp, const tile *tiles, int first, int end, const int *zeros,
+                  gen_stats *stats) {
+    gen_stats local, part;
+
+    clear_stats(&local);
+    for (int t = first; t < end; t++) {
+        evolve_rect(main, temp, tiles[t].r0, tiles[t].r1, tiles[t].c0, tiles[t].c1, zeros, &part);
+        merge_stats(&local, &part);
+    }
+    if (stats) *stats = local;
+}
+
+// Evolves rows [from, to) of G in place. above and below are copies
+// of the rows just outside the range as they were before this
+// generation, or NULL at the edge of the board. scratch holds three
+// rows: two take turns keeping the original of the current and the
+// previous row, the third stays zero and stands in for missing rows.
+void evolve_in_place(grid *G, int from, int to, const int *above, const int *below,
+                     int *scratch, gen_stats *stats) {
+    int cols = G->cols;
+    const int *zeros = scratch + 2 * (size_t)cols;
+    const int *up = above ? above : zeros;
+    gen_stats local;
+
+    clear_stats(&local);
+    for (int i = from; i < to; i++) {
+        int *mid = scratch + (size_t)((i - from) & 1) * cols;
+        const int *down = (i + 1 < to) ? G->val[i + 1] : (below ? below : zeros);
+
+        memcpy(mid, G->val[i], cols * sizeof(int));
+        evolve_row(up, mid, down, G->val[i], i, 0, cols, cols, &local);
+        up = mid;
+    }
+
+    if (stats) *stats = local;
+}
+
+// Looks at a specific part of our temp grid, and transfers
+// the values into our permanent grid. The values transferred
+// depend on the thread that calls the function.
+//
+void update_grid(grid *x, grid *y, int height, int part) {
+    for (int i = part; i < part + height; i++) {
+        for (int j = 0; j < x->cols; j++) {
+            x->val[i][j] = y->val[i][j];
+        }
+    }
+}
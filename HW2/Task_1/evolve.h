@@ -0,0 +1,31 @@
+#include "grid.h"
+#include "tiling.h"
+
+#ifndef _EVOLVE_H
+#define _EVOLVE_H
+
+// gen_stats describes one generation (or one section of it). The
+// bounding box covers all live cells; it is empty (min > max) if
+// there are none.
+typedef struct {
+    long population;
+    long births;
+    long deaths;
+    int min_row, max_row;
+    int min_col, max_col;
+} gen_stats;
+
+int count_neighbors(grid *G, int x, int y);
+void evolve_rect(grid *main, grid *temp, int r0, int r1, int c0, int c1, const int *zeros,
+                 gen_stats *stats);
+void evolve(grid *main, grid *temp, int height, int part, const int *zeros, gen_stats *stats);
+void evolve_tiles(grid *main, grid *temp, const tile *tiles, int first, int end, const int *zeros,
+                  gen_stats *stats);
+void evolve_in_place(grid *G, int from, int to, const int *above, const int *below,
+                     int *scratch, gen_stats *stats);
+void update_grid(grid *x, grid *y, int height, int part);
+void clear_stats(gen_stats *stats);
+void merge_stats(gen_stats *into, const gen_stats *from);
+void grid_stats(grid *G, gen_stats *stats);
+
+#endif
@@ -0,0 +1,56 @@
+#include <utility>
+
+#include "fixed.h"
+#include "fixed_board.h"
+
+// On x86-64 the specialized kernels are also built for AVX2 and picked
+// at load time where the CPU has it, which doubles the words per vector
+// operation.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define FIXED_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define FIXED_CLONES
+#endif
+
+namespace {
+
+template <int Rows, int Cols>
+FIXED_CLONES
+void EvolveGroup(uint64_t* cells, long generations) {
+    // Two boards of up to 128 x 128 words are about 270 KB, well within
+    // a thread's stack.
+    TFixedBoard<Rows, Cols> a, b;
+    TFixedBoard<Rows, Cols>* cur = &a;
+    TFixedBoard<Rows, Cols>* next = &b;
+
+    a.Load(cells);
+    for (long g = 0; g < generations; ++g) {
+        cur->Step(*next);
+        std::swap(cur, next);
+    }
+    cur->Store(cells);
+}
+
+} // namespace
+
+// The sizes with a specialized kernel: square boards of 32, 64 and 128.
+extern "C" int fixed_size_supported(int rows, int cols) {
+    return rows == cols && (rows == 32 || rows == 64 || rows == 128);
+}
+
+// Evolves a group of 64 bit-sliced boards (see batch.c) in place with
+// the kernel specialized for their size, which has to be supported.
+extern "C" void evolve_fixed_group(uint64_t* cells, int rows, int cols, long generations) {
+    (void)cols;
+    switch (rows) {
+        case 32:
+            EvolveGroup<32, 32>(cells, generations);
+            break;
+        case 64:
+            EvolveGroup<64, 64>(cells, generations);
+            break;
+        case 128:
+            EvolveGroup<128, 128>(cells, generations);
+            break;
+    }
+}
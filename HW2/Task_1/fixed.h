@@ -0,0 +1,17 @@
+#include <stdint.h>
+
+#ifndef _FIXED_H
+#define _FIXED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int fixed_size_supported(int rows, int cols);
+void evolve_fixed_group(uint64_t *cells, int rows, int cols, long generations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "bitlife.h"
+
+// 64 bit-sliced boards of a size known at compile time, laid out like
+// the groups of batch.c: word (i + 1, j + 1) holds cell (i, j) of all
+// boards, and a frame of dead words surrounds them. With the bounds
+// fixed a whole group lives in one flat array that fits on the stack.
+template <int Rows, int Cols>
+class TFixedBoard {
+    static constexpr int Stride = Cols + 2;
+
+    uint64_t Cells[(Rows + 2) * Stride];
+
+public:
+    TFixedBoard() {
+        std::memset(Cells, 0, sizeof(Cells));
+    }
+
+    // Copies the boards from and to the framed layout of batch.c.
+    void Load(const uint64_t* cells) {
+        std::memcpy(Cells, cells, sizeof(Cells));
+    }
+    void Store(uint64_t* cells) const {
+        std::memcpy(cells, Cells, sizeof(Cells));
+    }
+
+    // Writes the next generation of all 64 boards to next, whose frame
+    // has to be dead already. The three cells of every column are
+    // added once per row into a two-bit sum (Ones, Twos), and the
+    // window of three such sums is then added up for each cell, self
+    // included: the cell lives on with 3, or with 4 if it was alive.
+    // Both passes run over rows of compile-time length, so they are
+    // unrolled and vectorized, and the column sums stay on the stack.
+    void Step(TFixedBoard& next) const {
+        uint64_t ones[Stride], twos[Stride];
+
+        for (int i = 1; i <= Rows; ++i) {
+            const uint64_t* __restrict u = Cells + (i - 1) * Stride;
+            const uint64_t* __restrict m = Cells + i * Stride;
+            const uint64_t* __restrict d = Cells + (i + 1) * Stride;
+            uint64_t* __restrict out = next.Cells + i * Stride;
+
+            for (int j = 0; j < Stride; ++j) {
+                uint64_t um = u[j] ^ m[j];
+                ones[j] = um ^ d[j];
+                twos[j] = (u[j] & m[j]) | (d[j] & um);
+            }
+            for (int j = 1; j <= Cols; ++j) {
+                // ones of the window: bit 0 and a carry worth 2.
+                uint64_t ol = ones[j - 1], om = ones[j], orr = ones[j + 1];
+                uint64_t b0 = ol ^ om ^ orr;
+                uint64_t oc = (ol & om) | (orr & (ol ^ om));
+                // twos of the window: worth 2, with a carry worth 4.
+                uint64_t tl = twos[j - 1], tm = twos[j], tr = twos[j + 1];
+                uint64_t ts = tl ^ tm ^ tr;
+                uint64_t tc = (tl & tm) | (tr & (tl ^ tm));
+                // The total is b0 + 2 * (oc + ts) + 4 * tc.
+                uint64_t b1 = oc ^ ts;
+                uint64_t c4 = oc & ts;
+                uint64_t b2 = c4 ^ tc;
+                uint64_t b3 = c4 & tc;
+
+                out[j] = ~b3 & ((b0 & b1 & ~b2) | (m[j] & ~b0 & ~b1 & b2));
+            }
+        }
+    }
+};
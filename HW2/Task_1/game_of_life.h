@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include "gol.h"
+
+// Thin C++ owner of a gol_board (see gol.h).
+class TGameOfLife {
+    gol_board* Board;
+
+public:
+    TGameOfLife(int rows, int cols, int threads = 1)
+            : Board(gol_create(rows, cols, threads))
+    {
+        if (!Board)
+            throw std::invalid_argument("TGameOfLife: the board needs a positive size");
+    }
+    ~TGameOfLife() {
+        gol_destroy(Board);
+    }
+
+    TGameOfLife(const TGameOfLife&) = delete;
+    TGameOfLife& operator=(const TGameOfLife&) = delete;
+
+    int Rows() const {
+        return gol_rows(Board);
+    }
+    int Cols() const {
+        return gol_cols(Board);
+    }
+    bool Get(int row, int col) const {
+        return gol_get(Board, row, col) == 1;
+    }
+    void Set(int row, int col, bool alive) {
+        if (gol_set(Board, row, col, alive) != 0)
+            throw std::out_of_range("TGameOfLife: the cell is not on the board");
+    }
+    std::vector<unsigned char> Read(int row, int col, int height, int width) const {
+        std::vector<unsigned char> cells((size_t)height * width);
+        if (gol_read(Board, row, col, height, width, cells.data()) != 0)
+            throw std::out_of_range("TGameOfLife: the region is not on the board");
+        return cells;
+    }
+    void Randomize(unsigned int seed) {
+        gol_randomize(Board, seed);
+    }
+
+    void Step(long generations = 1) {
+        gol_step(Board, generations);
+    }
+    long Generation() const {
+        return gol_generation(Board);
+    }
+    long Population() const {
+        return gol_population(Board);
+    }
+};
@@ -0,0 +1,220 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "gol.h"
+#include "grid.h"
+#include "barrier.h"
+#include "evolve.h"
+
+struct gol_board {
+    grid *cur, *next;
+    int *zeros;                 // a dead row for the sections at the edges
+    int threads;
+    long generation;
+    long population;
+    gen_stats *stats;           // one slot per section
+
+    // The pool: workers sleep on wake until epoch changes, then run
+    // pending generations together with the calling thread, which
+    // works as section 0.
+    pthread_t *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    long epoch;
+    long pending;
+    int quit;
+    barrier barr;
+};
+
+// A worker of the pool, with the board and its section.
+typedef struct {
+    gol_board *board;
+    int section;
+} gol_worker;
+
+// Runs generations on one section. Every thread swaps its own copy of
+// the grid pointers, so the generations only need one barrier each.
+static void run_section(gol_board *B, int section, long generations) {
+    int from = (int)((long)B->cur->rows * section / B->threads);
+    int to = (int)((long)B->cur->rows * (section + 1) / B->threads);
+    grid *cur = B->cur, *next = B->next;
+
+    for (long g = 0; g < generations; g++) {
+        evolve(cur, next, to - from, from, B->zeros, &B->stats[section]);
+        barrier_wait(&B->barr);
+        grid *swap = cur;
+        cur = next;
+        next = swap;
+    }
+}
+
+static void *pool_thread(void *arguments) {
+    gol_worker *W = (gol_worker *)arguments;
+    gol_board *B = W->board;
+    long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&B->lock);
+        while (B->epoch == seen && !B->quit) {
+            pthread_cond_wait(&B->wake, &B->lock);
+        }
+        if (B->quit) {
+            pthread_mutex_unlock(&B->lock);
+            break;
+        }
+        seen = B->epoch;
+        long generations = B->pending;
+        pthread_mutex_unlock(&B->lock);
+
+        run_section(B, W->section, generations);
+    }
+    free(W);
+    return NULL;
+}
+
+// Creates a dead board of rows x cols evolved by the given number of
+// threads (at most one per row), NULL if the size is not positive.
+gol_board *gol_create(int rows, int cols, int threads) {
+    if (rows <= 0 || cols <= 0) {
+        return NULL;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > rows) threads = rows;
+
+    gol_board *B = malloc(sizeof(gol_board));
+    B->cur = init_grid(rows, cols);
+    B->next = init_grid(rows, cols);
+    B->zeros = calloc(cols, sizeof(int));
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            B->cur->val[i][j] = 0;
+        }
+    }
+    B->threads = threads;
+    B->generation = 0;
+    B->population = 0;
+    B->stats = calloc(threads, sizeof(gen_stats));
+    B->workers = malloc(threads * sizeof(pthread_t));
+    pthread_mutex_init(&B->lock, NULL);
+    pthread_cond_init(&B->wake, NULL);
+    B->epoch = 0;
+    B->pending = 0;
+    B->quit = 0;
+    barrier_init(&B->barr, threads);
+
+    for (int t = 1; t < threads; t++) {
+        gol_worker *W = malloc(sizeof(gol_worker));
+        W->board = B;
+        W->section = t;
+        pthread_create(&B->workers[t], NULL, &pool_thread, W);
+    }
+    return B;
+}
+
+void gol_destroy(gol_board *B) {
+    if (B == NULL) return;
+
+    pthread_mutex_lock(&B->lock);
+    B->quit = 1;
+    pthread_cond_broadcast(&B->wake);
+    pthread_mutex_unlock(&B->lock);
+    for (int t = 1; t < B->threads; t++) {
+        pthread_join(B->workers[t], NULL);
+    }
+
+    barrier_destroy(&B->barr);
+    pthread_cond_destroy(&B->wake);
+    pthread_mutex_destroy(&B->lock);
+    destroy_grid(B->cur);
+    destroy_grid(B->next);
+    free(B->zeros);
+    free(B->stats);
+    free(B->workers);
+    free(B);
+}
+
+int gol_rows(const gol_board *B) {
+    return B->cur->rows;
+}
+
+int gol_cols(const gol_board *B) {
+    return B->cur->cols;
+}
+
+static int on_board(const gol_board *B, int row, int col) {
+    return row >= 0 && col >= 0 && row < B->cur->rows && col < B->cur->cols;
+}
+
+// Sets a cell; returns -1 if it is not on the board.
+int gol_set(gol_board *B, int row, int col, int alive) {
+    if (!on_board(B, row, col)) {
+        return -1;
+    }
+    B->population += (alive != 0) - B->cur->val[row][col];
+    B->cur->val[row][col] = (alive != 0);
+    return 0;
+}
+
+// Returns a cell, -1 if it is not on the board.
+int gol_get(const gol_board *B, int row, int col) {
+    return on_board(B, row, col) ? B->cur->val[row][col] : -1;
+}
+
+// Copies a height x width region, one byte per cell row by row, into
+// cells; returns -1 if the region does not lie on the board.
+int gol_read(const gol_board *B, int row, int col, int height, int width, unsigned char *cells) {
+    if (height <= 0 || width <= 0 || !on_board(B, row, col) ||
+        !on_board(B, row + height - 1, col + width - 1)) {
+        return -1;
+    }
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            *cells++ = (unsigned char)B->cur->val[row + i][col + j];
+        }
+    }
+    return 0;
+}
+
+// Fills the board like random_populate_r, about a third alive.
+void gol_randomize(gol_board *B, unsigned int seed) {
+    gen_stats stats;
+
+    random_populate_r(B->cur, &seed);
+    grid_stats(B->cur, &stats);
+    B->population = stats.population;
+}
+
+// Evolves the board by the given number of generations with the pool.
+void gol_step(gol_board *B, long generations) {
+    if (generations <= 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&B->lock);
+    B->pending = generations;
+    B->epoch++;
+    pthread_cond_broadcast(&B->wake);
+    pthread_mutex_unlock(&B->lock);
+
+    run_section(B, 0, generations);
+
+    // After the last barrier every section is done, and the workers
+    // only look at the board again after the next wake up.
+    if (generations % 2) {
+        grid *swap = B->cur;
+        B->cur = B->next;
+        B->next = swap;
+    }
+    B->generation += generations;
+    B->population = 0;
+    for (int t = 0; t < B->threads; t++) {
+        B->population += B->stats[t].population;
+    }
+}
+
+long gol_generation(const gol_board *B) {
+    return B->generation;
+}
+
+long gol_population(const gol_board *B) {
+    return B->population;
+}
@@ -0,0 +1,31 @@
+#ifndef _GOL_H
+#define _GOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A board with its own pool of worker threads. The workers are started
+// by gol_create and parked between calls to gol_step, so stepping a
+// board costs no thread creation or barrier setup.
+typedef struct gol_board gol_board;
+
+gol_board *gol_create(int rows, int cols, int threads);
+void gol_destroy(gol_board *B);
+
+int gol_rows(const gol_board *B);
+int gol_cols(const gol_board *B);
+int gol_set(gol_board *B, int row, int col, int alive);
+int gol_get(const gol_board *B, int row, int col);
+int gol_read(const gol_board *B, int row, int col, int height, int width, unsigned char *cells);
+void gol_randomize(gol_board *B, unsigned int seed);
+
+void gol_step(gol_board *B, long generations);
+long gol_generation(const gol_board *B);
+long gol_population(const gol_board *B);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
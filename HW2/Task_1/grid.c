@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "grid.h"
+#include "reader.h"
 
 // Allocates memory for a grid (matrix) of dimensions
 // rows x cols.
@@ -47,12 +48,26 @@ void random_populate(grid *G, unsigned int seed) {
 
 }
 
-void manual_populate(grid *G) {
-    int k;
+// Same as random_populate, but keeps the generator state in *state
+// instead of the global one, so threads can populate boards side by
+// side. The sequence differs from random_populate for the same seed.
+void random_populate_r(grid *G, unsigned int *state) {
     for (int i = 0; i < G->rows; i++) {
         for (int j = 0; j < G->cols; j++) {
-            scanf("%i", &k);
-            G->val[i][j] = k;
+            G->val[i][j] = (rand_r(state) % 3 == 0);
         }
     }
 }
+
+// Reads the board from stdin. The input is pulled in large blocks
+// and parsed by a hand-written scanner (see reader.c), so even huge
+// boards load at close to the speed of the pipe.
+void manual_populate(grid *G) {
+    reader *R = init_reader(stdin, 1 << 20);
+    int rows = read_board(R, G);
+
+    if (rows >= 0 && rows < G->rows) {
+        fprintf(stderr, "Input ended after %d of %d rows, the rest is left dead.\n", rows, G->rows);
+    }
+    destroy_reader(R);
+}
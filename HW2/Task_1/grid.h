@@ -10,6 +10,7 @@ typedef struct {
 grid *init_grid(int rows, int cols);
 void destroy_grid(grid* G);
 void random_populate(grid *G, unsigned int seed);
+void random_populate_r(grid *G, unsigned int *state);
 void manual_populate(grid *G);
 
 #endif
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <getopt.h>
+#include "grid.h"
+#include "engine.h"
+#include "cycle.h"
+
+// The harness runs every engine of the registry on the same random
+// boards and compares the hash of each final board with the one of
+// the reference engine. The time spent in the steps is summed up per
+// engine, so every engine's speed is reported along with the proof
+// that it computes the same thing.
+
+#define MAX_ENGINES 16
+
+// How the starting board is filled.
+typedef enum {
+    FILL_UNIFORM,               // live cells anywhere
+    FILL_EDGES,                 // live cells only in the outer two rows and columns
+    FILL_EMPTY,
+    FILL_FULL,
+    FILLS
+} fill_mode;
+
+static const char *fill_names[FILLS] = {"uniform", "edges", "empty", "full"};
+
+typedef struct {
+    long cases;
+    long mismatches;
+    long failures;
+    double cells;               // cell updates done
+    long ns;                    // time spent stepping
+} engine_tally;
+
+// splitmix64, so every case can be reproduced from the seed alone.
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static int random_below(uint64_t *state, int n) {
+    return (int)(next_random(state) % (uint64_t)n);
+}
+
+static void fill_board(grid *G, fill_mode fill, double density, uint64_t *state) {
+    for (int i = 0; i < G->rows; i++) {
+        for (int j = 0; j < G->cols; j++) {
+            int edge = i < 2 || j < 2 || i >= G->rows - 2 || j >= G->cols - 2;
+            double r = (double)(next_random(state) >> 11) / (double)(1ULL << 53);
+
+            switch (fill) {
+                case FILL_UNIFORM: G->val[i][j] = r < density; break;
+                case FILL_EDGES: G->val[i][j] = edge && r < density; break;
+                case FILL_EMPTY: G->val[i][j] = 0; break;
+                default: G->val[i][j] = 1; break;
+            }
+        }
+    }
+}
+
+static long now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return 1000000000L * t.tv_sec + t.tv_nsec;
+}
+
+// Runs one engine on a copy of start and returns the hash of the
+// final board, with the time of the step added to the tally. An engine
+// that fails to start or to step is handed over to the reference
+// engine by create_engine and engine_step; that counts as a failure
+// here, or a broken engine would pass with the reference's board.
+static int run_case(const engine_ops *ops, grid *start, int threads, long generations,
+                    grid *final, uint64_t *hash, engine_tally *tally) {
+    engine *E = create_engine(ops, start, threads);
+    if (E == NULL) return -1;
+    if (E->ops != ops) {
+        destroy_engine(E);
+        return -1;
+    }
+
+    long t0 = now_ns();
+    int status = engine_step(E, generations);
+    tally->ns += now_ns() - t0;
+    if (E->ops != ops) status = -1;
+    tally->cells += (double)start->rows * start->cols * generations;
+
+    engine_export(E, final);
+    *hash = hash_rows(final, 0, final->rows);
+    destroy_engine(E);
+    return status;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n, --cases N         number of random boards (default 40)\n"
+            "  -s, --seed N          seed of the first board (default 1)\n"
+            "  -m, --max-size N      largest height and width (default 200)\n"
+            "  -g, --generations N   most generations per board (default 64)\n"
+            "  -t, --threads N       most threads per engine (default 4)\n"
+            "  -h, --help            show this message\n",
+            program);
+}
+
+int main(int argc, char **argv) {
+    long cases = 40, max_generations = 64;
+    int max_size = 200, max_threads = 4, opt;
+    uint64_t seed = 1;
+    static struct option long_options[] = {
+        {"cases", required_argument, NULL, 'n'},
+        {"seed", required_argument, NULL, 's'},
+        {"max-size", required_argument, NULL, 'm'},
+        {"generations", required_argument, NULL, 'g'},
+        {"threads", required_argument, NULL, 't'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "n:s:m:g:t:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'n': cases = atol(optarg); break;
+            case 's': seed = strtoull(optarg, NULL, 10); break;
+            case 'm': max_size = atoi(optarg); break;
+            case 'g': max_generations = atol(optarg); break;
+            case 't': max_threads = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (cases < 1 || max_size < 1 || max_generations < 0 || max_threads < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const engine_ops *reference = find_engine(REFERENCE_ENGINE);
+    engine_tally tallies[MAX_ENGINES] = {{0}};
+    long mismatches = 0, failures = 0;
+
+    for (long c = 0; c < cases; c++) {
+        uint64_t state = seed + (uint64_t)c;
+        int rows = 1 + random_below(&state, max_size);
+        int cols = 1 + random_below(&state, max_size);
+        fill_mode fill = (fill_mode)random_below(&state, FILLS);
+        double density = 0.05 + 0.6 * random_below(&state, 1000) / 1000.0;
+        long generations = random_below(&state, (int)max_generations + 1);
+        int threads = 1 + random_below(&state, max_threads);
+        grid *start = init_grid(rows, cols);
+        grid *final = init_grid(rows, cols);
+        uint64_t expected, hash;
+
+        fill_board(start, fill, density, &state);
+        if (run_case(reference, start, threads, generations, final, &expected, &tallies[0]) != 0) {
+            fprintf(stderr, "The reference engine failed on case %ld.\n", c);
+            return 1;
+        }
+        tallies[0].cases++;
+
+        for (int e = 1; e < MAX_ENGINES && engine_at(e); e++) {
+            const engine_ops *ops = engine_at(e);
+            tallies[e].cases++;
+            if (run_case(ops, start, threads, generations, final, &hash, &tallies[e]) != 0) {
+                tallies[e].failures++;
+                failures++;
+                fprintf(stderr, "Failure: engine %s, case %ld (seed %llu)\n", ops->name, c,
+                        (unsigned long long)(seed + c));
+            } else if (hash != expected) {
+                tallies[e].mismatches++;
+                mismatches++;
+                fprintf(stderr, "Mismatch: engine %s, case %ld (seed %llu): %d x %d, %s fill, density %.3f, %ld generations, %d threads\n",
+                        ops->name, c, (unsigned long long)(seed + c), rows, cols, fill_names[fill],
+                        density, generations, threads);
+            }
+        }
+        destroy_grid(start);
+        destroy_grid(final);
+    }
+
+    printf("Engine;Cases;Mismatches;Failures;Cell updates per second\n");
+    for (int e = 0; e < MAX_ENGINES && engine_at(e); e++) {
+        printf("%s;%ld;%ld;%ld;%.0f\n", engine_at(e)->name, tallies[e].cases, tallies[e].mismatches,
+               tallies[e].failures, tallies[e].ns ? tallies[e].cells * 1e9 / tallies[e].ns : 0.0);
+    }
+    return mismatches || failures ? 1 : 0;
+}
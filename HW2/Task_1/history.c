@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <string.h>
+#include "history.h"
+
+// Memory held by a segment, as counted against the budget.
+static size_t segment_bytes(const history *H, const history_segment *S) {
+    return (size_t)H->rows * H->words * sizeof(uint64_t) + S->cap + S->offsets_cap * sizeof(size_t);
+}
+
+static void free_segment(history_segment *S) {
+    free(S->keyframe);
+    free(S->offsets);
+    free(S->bytes);
+}
+
+// Starts a segment at generation with the current board as keyframe.
+static void start_segment(history *H, long generation) {
+    size_t size = (size_t)H->rows * H->words * sizeof(uint64_t);
+
+    if (H->segment_count == H->segment_cap) {
+        H->segment_cap = H->segment_cap ? 2 * H->segment_cap : 8;
+        H->segments = realloc(H->segments, H->segment_cap * sizeof(history_segment));
+    }
+    history_segment *S = &H->segments[H->segment_count++];
+    S->first = generation;
+    S->count = 0;
+    S->keyframe = malloc(size);
+    memcpy(S->keyframe, H->current->bits, size);
+    S->offsets_cap = H->keyframe_every + 1;
+    S->offsets = malloc(S->offsets_cap * sizeof(size_t));
+    S->offsets[0] = 0;
+    S->bytes = NULL;
+    S->used = 0;
+    S->cap = 0;
+    H->bytes += segment_bytes(H, S);
+}
+
+// Drops the oldest segments while the history is over budget.
+static void enforce_budget(history *H) {
+    while (H->bytes > H->budget && H->segment_count > 1) {
+        H->bytes -= segment_bytes(H, &H->segments[0]);
+        free_segment(&H->segments[0]);
+        H->segment_count--;
+        memmove(H->segments, H->segments + 1, H->segment_count * sizeof(history_segment));
+        H->dropped++;
+    }
+}
+
+// Appends value to the segment as a LEB128 varint.
+static void put_varint(history *H, history_segment *S, uint64_t value) {
+    if (S->cap - S->used < 10) {
+        size_t cap = S->cap ? 2 * S->cap : 256;
+        H->bytes += cap - S->cap;
+        S->bytes = realloc(S->bytes, cap);
+        S->cap = cap;
+    }
+    while (value >= 0x80) {
+        S->bytes[S->used++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    S->bytes[S->used++] = (uint8_t)value;
+}
+
+// Records G, the board at generation, as the start of the history.
+// sections is the number of threads that will call history_diff.
+history *init_history(grid *G, long generation, int sections, int keyframe_every, size_t budget) {
+    history *H = (history *)malloc(sizeof(history));
+    H->rows = G->rows;
+    H->cols = G->cols;
+    H->words = BITGRID_WORDS(G->cols);
+    H->keyframe_every = keyframe_every;
+    H->budget = budget;
+    H->current = init_bitgrid(G->rows, G->cols);
+    pack_rows(H->current->bits, G, 0, G->rows);
+    H->changes = calloc(sections, sizeof(history_changes));
+    H->sections = sections;
+    H->segments = NULL;
+    H->segment_count = 0;
+    H->segment_cap = 0;
+    H->bytes = 0;
+    H->dropped = 0;
+    start_segment(H, generation);
+    return H;
+}
+
+void destroy_history(history *H) {
+    for (int i = 0; i < H->segment_count; i++) {
+        free_segment(&H->segments[i]);
+    }
+    for (int i = 0; i < H->sections; i++) {
+        free(H->changes[i].cells);
+    }
+    free(H->segments);
+    free(H->changes);
+    destroy_bitgrid(H->current);
+    free(H);
+}
+
+// Collects the cells of rows [from, to) of G that differ from the
+// recorded board into the section's change list and records them.
+// Sections must not overlap, and they must be done before the
+// generation is committed.
+void history_diff(history *H, int section, grid *G, int from, int to) {
+    history_changes *C = &H->changes[section];
+
+    for (int i = from; i < to; i++) {
+        const int *row = G->val[i];
+        uint64_t *old = H->current->bits + (size_t)i * H->words;
+
+        for (int w = 0; w < H->words; w++) {
+            int base = w * 64;
+            int n = H->cols - base < 64 ? H->cols - base : 64;
+            uint64_t word = 0;
+            for (int k = 0; k < n; k++) {
+                word |= (uint64_t)(row[base + k] & 1) << k;
+            }
+            uint64_t flipped = word ^ old[w];
+            old[w] = word;
+
+            while (flipped) {
+                if (C->count == C->cap) {
+                    C->cap = C->cap ? 2 * C->cap : 1024;
+                    C->cells = realloc(C->cells, C->cap * sizeof(uint64_t));
+                }
+                C->cells[C->count++] = (uint64_t)i * H->cols + base + __builtin_ctzll(flipped);
+                flipped &= flipped - 1;
+            }
+        }
+    }
+}
+
+// Appends generation, whose sections have all been diffed, to the
+// history. Called by one thread while no section is being diffed.
+void history_commit(history *H, long generation) {
+    history_segment *S = &H->segments[H->segment_count - 1];
+
+    if (generation != S->first + S->count + 1 || S->count + 1 >= H->keyframe_every) {
+        // The new generation is a keyframe; its flips are in the board.
+        start_segment(H, generation);
+    } else {
+        // The sections cover the rows in order, so the cells are sorted.
+        uint64_t previous = 0;
+        for (int t = 0; t < H->sections; t++) {
+            history_changes *C = &H->changes[t];
+            for (size_t k = 0; k < C->count; k++) {
+                put_varint(H, S, C->cells[k] - previous);
+                previous = C->cells[k];
+            }
+        }
+        S->offsets[++S->count] = S->used;
+    }
+    for (int t = 0; t < H->sections; t++) {
+        H->changes[t].count = 0;
+    }
+    enforce_budget(H);
+}
+
+// The oldest generation still in the history.
+long history_first(const history *H) {
+    return H->segments[0].first;
+}
+
+// The latest recorded generation.
+long history_last(const history *H) {
+    const history_segment *S = &H->segments[H->segment_count - 1];
+    return S->first + S->count;
+}
+
+// Reconstructs the board at generation into G, which must be as big
+// as the recorded board: its keyframe with the flips of the following
+// generations applied. Returns -1 if generation is not in the history.
+int rewind_history(const history *H, long generation, grid *G) {
+    const history_segment *S = NULL;
+
+    for (int i = H->segment_count - 1; i >= 0; i--) {
+        if (H->segments[i].first <= generation) {
+            S = &H->segments[i];
+            break;
+        }
+    }
+    if (S == NULL || generation > S->first + S->count || G->rows != H->rows || G->cols != H->cols) {
+        return -1;
+    }
+
+    size_t words = (size_t)H->rows * H->words;
+    uint64_t *bits = malloc(words * sizeof(uint64_t));
+    memcpy(bits, S->keyframe, words * sizeof(uint64_t));
+
+    for (long k = 0; k < generation - S->first; k++) {
+        const uint8_t *p = S->bytes + S->offsets[k];
+        const uint8_t *end = S->bytes + S->offsets[k + 1];
+        uint64_t cell = 0;
+
+        while (p < end) {
+            uint64_t gap = 0;
+            int shift = 0;
+            do {
+                gap |= (uint64_t)(*p & 0x7f) << shift;
+                shift += 7;
+            } while (*p++ & 0x80);
+            cell += gap;
+
+            uint64_t i = cell / H->cols, j = cell % H->cols;
+            bits[i * H->words + (j >> 6)] ^= (uint64_t)1 << (j & 63);
+        }
+    }
+    unpack_rows(G, bits, 0, G->rows);
+    free(bits);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "grid.h"
+#include "bitgrid.h"
+
+#ifndef _HISTORY_H
+#define _HISTORY_H
+
+// A run of generations in the history: the packed board at first
+// (the keyframe), followed by the cells that flipped in each of the
+// next count generations. The flips of generation first + k + 1 are
+// bytes[offsets[k], offsets[k + 1]), their cell indices in increasing
+// order, stored as the gaps between them in LEB128 varints.
+typedef struct {
+    long first;
+    long count;
+    uint64_t *keyframe;
+    size_t *offsets;            // count + 1 entries
+    size_t offsets_cap;
+    uint8_t *bytes;
+    size_t used, cap;
+} history_segment;
+
+// A section's flips of the current generation, before they are merged.
+typedef struct {
+    uint64_t *cells;
+    size_t count, cap;
+} history_changes;
+
+// history records every generation of a run in bounded memory. The
+// compute threads diff their sections against current as they go
+// (history_diff), and one of them appends the generation once every
+// section is done (history_commit). Every keyframe_every generations
+// a new segment starts; when the history grows beyond budget bytes,
+// whole segments are dropped from the oldest, so the latest segment
+// always stays.
+typedef struct {
+    int rows, cols, words;
+    int keyframe_every;
+    size_t budget;
+    bitgrid *current;           // the board at the last recorded generation
+    history_changes *changes;   // one per section
+    int sections;
+    history_segment *segments;  // oldest first
+    int segment_count, segment_cap;
+    size_t bytes;               // memory held by the segments
+    long dropped;               // segments dropped for the budget
+} history;
+
+history *init_history(grid *G, long generation, int sections, int keyframe_every, size_t budget);
+void destroy_history(history *H);
+void history_diff(history *H, int section, grid *G, int from, int to);
+void history_commit(history *H, long generation);
+long history_first(const history *H);
+long history_last(const history *H);
+int rewind_history(const history *H, long generation, grid *G);
+
+#endif
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "live.h"
+#include "bitgrid.h"
+
+// A copy that keeps failing its check is given up on after this many
+// tries, so a reader never spins forever on a stalled slot.
+#define LIVE_READ_TRIES 64
+
+static uint64_t *slot_frame(const live_header *H, int slot) {
+    return (uint64_t *)((char *)H + LIVE_PAYLOAD_OFFSET + (size_t)slot * H->frame_size);
+}
+
+// Creates (or replaces) the shared memory segment name for a rows x
+// cols board that publishes every interval generations.
+live_feed *open_live_feed(const char *name, int rows, int cols, int interval) {
+    live_feed *F = calloc(1, sizeof(live_feed));
+    uint64_t frame_size = (uint64_t)rows * BITGRID_WORDS(cols) * sizeof(uint64_t);
+
+    snprintf(F->name, sizeof(F->name), "%s", name);
+    F->interval = interval;
+    F->size = LIVE_PAYLOAD_OFFSET + LIVE_SLOTS * frame_size;
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        free(F);
+        return NULL;
+    }
+    if (ftruncate(fd, F->size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        free(F);
+        return NULL;
+    }
+    F->header = mmap(NULL, F->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (F->header == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(name);
+        free(F);
+        return NULL;
+    }
+
+    live_header *H = F->header;
+    H->rows = rows;
+    H->cols = cols;
+    H->frame_size = frame_size;
+    atomic_init(&H->published, 0);
+    atomic_init(&H->closed, 0);
+    for (int i = 0; i < LIVE_SLOTS; i++) {
+        atomic_init(&H->slots[i].seq, 0);
+        H->slots[i].generation = 0;
+    }
+    // Readers check the magic last, so it goes in once the rest is set.
+    atomic_thread_fence(memory_order_release);
+    memcpy(H->magic, LIVE_MAGIC, sizeof(H->magic));
+    return F;
+}
+
+// Marks the feed as finished and removes its name. Viewers that have
+// it mapped keep the last frames.
+void close_live_feed(live_feed *F) {
+    atomic_store_explicit(&F->header->closed, 1, memory_order_release);
+    munmap(F->header, F->size);
+    shm_unlink(F->name);
+    free(F);
+}
+
+int live_due(live_feed *F, long generation) {
+    return generation % F->interval == 0;
+}
+
+// Opens the slot after the newest frame for writing and returns it.
+// Called by one thread before the sections pack the generation.
+uint64_t *live_acquire(live_feed *F) {
+    live_header *H = F->header;
+    unsigned long published = atomic_load_explicit(&H->published, memory_order_relaxed);
+    live_slot *S;
+
+    F->slot = (int)(published % LIVE_SLOTS);
+    S = &H->slots[F->slot];
+    atomic_store_explicit(&S->seq, atomic_load_explicit(&S->seq, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    F->frame = slot_frame(H, F->slot);
+    return F->frame;
+}
+
+// The frame being filled, or NULL.
+uint64_t *live_frame(live_feed *F) {
+    return F->frame;
+}
+
+// Publishes the filled frame as generation. Called by one thread once
+// every section has been packed.
+void live_submit(live_feed *F, long generation) {
+    live_header *H = F->header;
+    live_slot *S = &H->slots[F->slot];
+
+    S->generation = (uint64_t)generation;
+    atomic_store_explicit(&S->seq, atomic_load_explicit(&S->seq, memory_order_relaxed) + 1,
+                          memory_order_release);
+    atomic_fetch_add_explicit(&H->published, 1, memory_order_release);
+    F->frame = NULL;
+}
+
+// Maps the feed published under name read-only. Returns NULL if there
+// is none.
+live_reader *attach_live_feed(const char *name) {
+    struct stat st;
+    int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < LIVE_PAYLOAD_OFFSET) {
+        close(fd);
+        return NULL;
+    }
+    live_reader *R = malloc(sizeof(live_reader));
+    R->size = st.st_size;
+    R->header = mmap(NULL, R->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (R->header == MAP_FAILED || memcmp(R->header->magic, LIVE_MAGIC, sizeof(R->header->magic)) != 0) {
+        if (R->header != MAP_FAILED) munmap((void *)R->header, R->size);
+        free(R);
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return R;
+}
+
+void detach_live_feed(live_reader *R) {
+    munmap((void *)R->header, R->size);
+    free(R);
+}
+
+// Copies the newest consistent frame into bits (frame_size bytes) and
+// its generation into generation. Never blocks the publisher: a copy
+// that was overwritten meanwhile is simply retried. Returns -1 if
+// nothing has been published yet or no copy succeeded.
+int read_live_frame(live_reader *R, uint64_t *bits, long *generation) {
+    const live_header *H = R->header;
+
+    for (int tries = 0; tries < LIVE_READ_TRIES; tries++) {
+        unsigned long published = atomic_load_explicit(&H->published, memory_order_acquire);
+        if (published == 0) {
+            return -1;
+        }
+        int slot = (int)((published - 1) % LIVE_SLOTS);
+        const live_slot *S = &H->slots[slot];
+        unsigned long before = atomic_load_explicit(&S->seq, memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(bits, slot_frame(H, slot), H->frame_size);
+        long gen = (long)S->generation;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&S->seq, memory_order_relaxed) == before) {
+            *generation = gen;
+            return 0;
+        }
+    }
+    return -1;
+}
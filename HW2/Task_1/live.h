@@ -0,0 +1,67 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifndef _LIVE_H
+#define _LIVE_H
+
+#define LIVE_MAGIC "GOLLIVE1"
+#define LIVE_SLOTS 3
+
+// Frames start on their own page, like a checkpoint payload.
+#define LIVE_PAYLOAD_OFFSET 4096
+
+// A frame slot. seq is odd while the slot is being written; a reader
+// copies the frame and only keeps it if seq was even and unchanged
+// around the copy.
+typedef struct {
+    atomic_ulong seq;
+    uint64_t generation;
+} live_slot;
+
+// Header at the start of the shared memory segment, followed at
+// LIVE_PAYLOAD_OFFSET by LIVE_SLOTS frames of frame_size bytes, each
+// packed like bitgrid::bits. The publisher writes the slot after the
+// newest one in turn, so a reader has two publishing intervals to copy
+// the newest frame before it is overwritten, and the publisher never
+// waits for anybody.
+typedef struct {
+    char magic[8];
+    int32_t rows;
+    int32_t cols;
+    uint64_t frame_size;
+    atomic_ulong published;     // frames published so far
+    atomic_int closed;          // the run is over
+    live_slot slots[LIVE_SLOTS];
+} live_header;
+
+// live_feed publishes frames of a running board under a POSIX shared
+// memory name. Like stream, the compute threads pack their sections
+// into the frame between live_acquire and live_submit.
+typedef struct {
+    char name[256];
+    int interval;
+    size_t size;
+    live_header *header;
+    uint64_t *frame;            // frame being written, NULL if none
+    int slot;
+} live_feed;
+
+// A reader's mapping of somebody else's feed.
+typedef struct {
+    size_t size;
+    const live_header *header;
+} live_reader;
+
+live_feed *open_live_feed(const char *name, int rows, int cols, int interval);
+void close_live_feed(live_feed *F);
+int live_due(live_feed *F, long generation);
+uint64_t *live_acquire(live_feed *F);
+uint64_t *live_frame(live_feed *F);
+void live_submit(live_feed *F, long generation);
+
+live_reader *attach_live_feed(const char *name);
+void detach_live_feed(live_reader *R);
+int read_live_frame(live_reader *R, uint64_t *bits, long *generation);
+
+#endif
@@ -1,189 +1,840 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <pthread.h>
 #include "grid.h"
 #include "tinfo.h"
 #include "barrier.h"
+#include "pattern.h"
+#include "output.h"
+#include "options.h"
+#include "checkpoint.h"
+#include "stream.h"
+#include "ooc.h"
+#include "mproc.h"
+#include "cycle.h"
+#include "evolve.h"
+#include "cone.h"
+#include "batch.h"
+#include "engine.h"
+#include "tune.h"
+#include "history.h"
+#include "view.h"
+#include "live.h"
+#include "sat.h"
+#include "soup.h"
 
 // Initiate a barrier object
 barrier barr;
 
-// This function counts the neighbors of a point in our grid.
-int count_neighbors(grid *G, int x, int y) {
-    int i, j, count = 0;
-    for (i = x - 1; i <= x + 1; i++) {
-        for (j = y - 1;j <= y + 1; j++) {
-            if ((i == x && j == y) || (i < 0 || j < 0) || (i >= G->rows || j >= G->cols)) {
-                continue;
+// Generations timed for every configuration while tuning, and how
+// many times; the fastest round counts, so a cold first run does not.
+#define TUNE_GENERATIONS 4
+#define TUNE_ROUNDS 2
+
+// Sums up the statistics of all sections and writes them out. Only
+// one thread calls it, while every section is done with evolve.
+static void report_stats(tinfo *info, long generation) {
+    gen_stats total = info->stats[0];
+    for (int t = 1; t < info->divide; t++) {
+        merge_stats(&total, &info->stats[t]);
+    }
+    write_stats(info->stats_out, generation, &total);
+}
+
+// Rows [from, to) of G hold the new generation of this thread's
+// section and nobody writes them until the next barrier, so this is
+// where the section is packed for the checkpoint and the streamed
+// frame, hashed for the cycle detector, diffed for the history, packed
+// for the live feed and summed up for the region counts.
+static void section_hooks(tinfo *info, grid *G, int from, int to, int snapshot, int streamed, int published) {
+    if (snapshot) pack_rows(info->ckpt->staging->bits, G, from, to);
+    if (streamed && stream_frame(info->frames)) pack_rows(stream_frame(info->frames), G, from, to);
+    if (published) pack_rows(live_frame(info->live), G, from, to);
+    if (info->cycles) cycle_store(info->cycles, info->section, hash_rows(G, from, to));
+    if (info->past) history_diff(info->past, info->section, G, from, to);
+    if (info->regions) sat_band(info->regions->table, G, info->section);
+}
+
+// thread_func is the general function passed to each thread. It is responsible
+// for computing the evolved values of a certain section of grid,
+// and then updating main grid to contain these values.
+void *thread_func(void *arguments) {
+    tinfo *info = (tinfo *)arguments;
+
+    grid *main = info->in;
+    grid *temp = info->out;
+    int div = info->divide;
+
+    int height = (int)(main->rows / div);
+    int part = height * info->section;
+    checkpointer *ckpt = info->ckpt;
+    stream *frames = info->frames;
+    cycle_detector *cycles = info->cycles;
+    long last = info->start + info->gen;
+    gen_stats *stats = info->stats ? &info->stats[info->section] : NULL;
+    int cols = main->cols;
+    int *scratch = NULL, *top = NULL, *bottom = NULL, *zeros = NULL;
+    const int *above = NULL, *below = NULL;
+
+    // In place, every section keeps copies of its first and last row
+    // for the neighbours, and three rows of scratch for itself.
+    if (info->edges) {
+        scratch = calloc(3 * (size_t)cols, sizeof(int));
+        top = info->edges + 2 * (size_t)info->section * cols;
+        bottom = top + cols;
+        if (info->section > 0) above = top - cols;
+        if (info->section + 1 < div) below = bottom + cols;
+    } else {
+        // Stands in for the rows beyond the edges of the board.
+        zeros = calloc(cols, sizeof(int));
+    }
+
+    if (cycles) {
+        cycle_store(cycles, info->section, hash_rows(main, part, part + height));
+        barrier_wait(&barr);
+        last = cycle_check(cycles, info->section, info->start, last);
+    }
+
+    // we need to wait other threads before we start to update the main grid
+    // and before we start another evolve loop
+    for (long generation = info->start + 1; generation <= last; generation++) {
+        int snapshot = ckpt && checkpoint_due(ckpt, generation);
+        int streamed = frames && stream_due(frames, generation);
+        int published = info->live && live_due(info->live, generation);
+
+        if (info->edges) {
+            // The neighbours read the edge copies while this section is
+            // overwritten; they stay put until the second barrier.
+            memcpy(top, main->val[part], cols * sizeof(int));
+            memcpy(bottom, main->val[part + height - 1], cols * sizeof(int));
+            if (info->section == 0) {
+                if (snapshot) checkpoint_acquire(ckpt);
+                if (streamed) stream_acquire(frames);
+                if (published) live_acquire(info->live);
             }
-            if(G->val[i][j] == 1) {
-                count++;
+            barrier_wait(&barr);
+
+            evolve_in_place(main, part, part + height, above, below, scratch, stats);
+            section_hooks(info, main, part, part + height, snapshot, streamed, published);
+            barrier_wait(&barr);
+
+            if (info->stats_out && info->section == 0) report_stats(info, generation);
+        } else {
+            if (info->tiles) {
+                evolve_tiles(main, temp, info->tiles->tiles, info->tiles->first[info->section],
+                             info->tiles->first[info->section + 1], zeros, stats);
+            } else {
+                evolve(main, temp, height, part, zeros, stats);
+            }
+            if (info->section == 0) {
+                if (snapshot) checkpoint_acquire(ckpt);
+                if (streamed) stream_acquire(frames);
+                if (published) live_acquire(info->live);
+            }
+            barrier_wait(&barr);
+
+            // The sections' statistics are final now and stay untouched
+            // until the next evolve, so one thread can reduce them.
+            if (info->stats_out && info->section == 0) report_stats(info, generation);
+
+            // temp is read-only while the main grid is updated.
+            update_grid(main, temp, height, part);
+            section_hooks(info, temp, part, part + height, snapshot, streamed, published);
+            barrier_wait(&barr);
+        }
+
+        if (info->section == 0) {
+            if (snapshot) checkpoint_submit(ckpt, generation);
+            if (streamed) stream_submit(frames, generation);
+            if (published) live_submit(info->live, generation);
+            if (info->past) history_commit(info->past, generation);
+            if (info->regions) {
+                sat_finish(info->regions->table);
+                write_region_counts(info->regions, generation);
             }
         }
+        if (cycles) last = cycle_check(cycles, info->section, generation, last);
     }
-    return count;
+    free(scratch);
+    free(zeros);
+    info->finished = last;
+    return NULL;
 }
 
+// Runs thread_func on threads_number sections, each with a copy of
+// proto, and waits for them. Returns the threads' tinfo structs.
+static tinfo **run_sections(const tinfo *proto, int threads_number) {
+    tinfo **thread_infos = malloc(threads_number * sizeof(tinfo *));
+    pthread_t threads[threads_number];
 
-// evolve function looks at a section of the main grid, and
-// proceeds to count the neighbors for each entry. Based on the neighbor
-// count, the function passes a value indicating cell death or
-// cell birth to temp grid.
-void evolve(grid *main, grid *temp, int height, int part) {
+    barrier_init(&barr, threads_number);
+    for (int i = 0; i < threads_number; i++) {
+        thread_infos[i] = init_tinfo();
+        *thread_infos[i] = *proto;
+        thread_infos[i]->section = i;
+        thread_infos[i]->divide = threads_number;
+    }
 
-    int i, j, neighbors;
+    // Initialize a number of threads. Each thread works on a portion of our
+    // grid
+    for (int i = 0; i < threads_number; i++) {
+        pthread_create(&threads[i], NULL, &thread_func, (void *)thread_infos[i]);
+    }
+    for (int i = 0; i < threads_number; i++) {
+        pthread_join(threads[i], NULL);
+    }
 
-    // Examine a specific part of G
-    for (i = part; i < part + height; i++) {
-        for (j = 0; j < main->cols; j++) {
+    barrier_destroy(&barr);
+    return thread_infos;
+}
 
-            neighbors = count_neighbors(main, i, j);
+// Times a few generations of a random rows x cols board run the way
+// c describes.
+static long trial_config(const tune_config *c, int rows, int cols, int generations) {
+    struct timespec t1, t2;
+    unsigned int seed = 132;
+    grid *G = init_grid(rows, cols);
 
-            // Determine which cells are born and which die.
-            if (main->val[i][j] == 1 && (neighbors < 2 || neighbors > 3)) {
-                temp->val[i][j] = 0;
-            } else if (main->val[i][j] == 0 && neighbors == 3) {
-                temp->val[i][j] = 1;
-            }
+    random_populate_r(G, &seed);
+    if (c->engine[0]) {
+        engine *E = create_engine(find_engine(c->engine), G, c->threads);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        engine_step(E, generations);
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        destroy_engine(E);
+    } else {
+        grid *temp = init_grid(rows, cols);
+        tinfo *proto = init_tinfo();
+        tiling *tiles = NULL;
+
+        update_grid(temp, G, rows, 0);
+        if (c->tile_rows > 0) {
+            tiles = init_tiling(rows, cols, c->threads, c->tile_rows, c->tile_cols);
+        }
+        proto->in = G;
+        proto->out = temp;
+        proto->gen = generations;
+        proto->tiles = tiles;
+
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        tinfo **infos = run_sections(proto, c->threads);
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+
+        for (int i = 0; i < c->threads; i++) {
+            free(infos[i]);
         }
+        free(infos);
+        free(proto);
+        if (tiles) destroy_tiling(tiles);
+        destroy_grid(temp);
     }
+    destroy_grid(G);
+    return 1000000000 * (t2.tv_sec - t1.tv_sec) + (t2.tv_nsec - t1.tv_nsec);
 }
 
+// Fills configs with the tuning of a rows x cols board: from the cache,
+// or, if the size is not in it or retune is set, by timing a few
+// generations of every candidate and saving the results. Returns the
+// number of configurations.
+static int tune_board(const char *cache, int rows, int cols, int retune, tune_config *configs) {
+    int count = retune ? 0 : load_tuning(cache, rows, cols, configs, TUNE_MAX_CONFIGS);
 
-// Looks at a specific part of our temp grid, and transfers
-// the values into our permanent grid. The values transferred
-// depend on the thread that calls the function.
-//
-void update_grid(grid *x, grid *y, int height, int part) {
-    for (int i = part; i < part + height; i++) {
-        for (int j = 0; j < x->cols; j++) {
-            x->val[i][j] = y->val[i][j];
+    if (count > 0) {
+        return count;
+    }
+    count = tune_candidates(rows, cols, configs, TUNE_MAX_CONFIGS);
+    for (int i = 0; i < count; i++) {
+        for (int round = 0; round < TUNE_ROUNDS; round++) {
+            long ns = trial_config(&configs[i], rows, cols, TUNE_GENERATIONS);
+            if (round == 0 || ns < configs[i].ns) configs[i].ns = ns;
         }
     }
+    if (save_tuning(cache, rows, cols, configs, count) == 0) {
+        printf("Tried %d configurations for a %d x %d board, saved to %s.\n", count, rows, cols, cache);
+    }
+    return count;
+}
+
+// The bounding box of the live cells of a generation, from the
+// statistics of its sections.
+static tile live_box(const gen_stats *stats, int sections) {
+    gen_stats total = stats[0];
+    tile box = {0, 0, 0, 0};
+
+    for (int t = 1; t < sections; t++) {
+        merge_stats(&total, &stats[t]);
+    }
+    if (total.population > 0) {
+        box.r0 = total.min_row;
+        box.r1 = total.max_row + 1;
+        box.c0 = total.min_col;
+        box.c1 = total.max_col + 1;
+    }
+    return box;
 }
 
-void print_grid(grid *G, char *label) {
-    printf("%s\n", label);
-
-    for (int i = 0; i < G->rows; i++) {
-        for (int j = 0; j < G->cols; j++) {
-            switch (G->val[i][j]) {
-                case 0:
-                    putchar('0');
-                    break;
-                case 1:
-                    putchar('1');
-                    break;
-                default:
-                    break;
-            }
+// Renders the W x H view of the board in src that opts asks for and
+// writes it to opts->output, or to stdout.
+static int print_view(const options *opts, const view_source *src, int threads, const char *label) {
+    tile region = {0, src->rows, 0, src->cols};
+    uint8_t *shade = malloc((size_t)opts->view_width * opts->view_height);
+    FILE *out = stdout;
+
+    render_view(src, region, opts->view_width, opts->view_height, threads, shade);
+    if (opts->output) {
+        out = fopen(opts->output, "wb");
+        if (out == NULL) {
+            perror(opts->output);
+            free(shade);
+            return -1;
         }
-        putchar('\n');
     }
-    putchar('\n');
+    write_view(out, shade, opts->view_width, opts->view_height, opts->view_format, label);
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(shade);
+    return 0;
 }
 
-// thread_func is the general function passed to each thread. It is responsible
-// for computing the evolved values of a certain section of grid,
-// and then updating main grid to contain these values.
-void *thread_func(void *arguments) {
-    tinfo *info = (tinfo *)arguments;
+// The out-of-core variant of main: the board never exists as a grid,
+// it is streamed between two memory-mapped files in packed form.
+// Only random populating is available for new boards.
+int out_of_core_main(options *opts) {
+    int g, rows = 0, cols = 0, threads_number;
+    struct timespec mt1, mt2;
+    long population;
+    checkpoint_header header;
 
-    grid *main = info->in;
-    grid *temp = info->out;
-    int div = info->divide;
+    printf("Welcome to the Multithreaded Game of Life (out-of-core board in %s).\n", opts->ooc);
+    if (ooc_board_exists(opts->ooc)) {
+        if (read_checkpoint_header(opts->ooc, &header) != 0) {
+            return 1;
+        }
+        rows = header.rows;
+        printf("Resuming a %d x %d board at generation %lu.\n", header.rows, header.cols,
+               (unsigned long)header.generation);
+    } else {
+        printf("Enter the height of the board: ");
+        scanf("%d", &rows);
+        printf("Enter the width of the board: ");
+        scanf("%d", &cols);
+    }
+    printf("Enter the number of generations: ");
+    scanf("%d", &g);
+    printf("Please enter a divisor of %d to determine the number of threads: ", rows);
+    scanf("%d", &threads_number);
+    while (rows % threads_number != 0) {
+        printf("I'm sorry, %d does not divide %d. Please choose a divisor of %d: ", threads_number, rows, rows);
+        scanf("%d", &threads_number);
+    }
 
-    int height = (int)(main->rows / div);
-    int part = height * info->section;
+    ooc_board *board = open_ooc_board(opts->ooc, rows, cols, 132, threads_number);
+    if (board == NULL) {
+        return 1;
+    }
 
-    // we need to wait other threads before we start to update the main grid
-    // and before we start another evolve loop
-    for (int i = 0; i < info->gen; i++) {
-        evolve(main, temp, height, part);
-        barrier_wait(&barr);
-        update_grid(main, temp, height, part);
-        barrier_wait(&barr);
+    clock_gettime(CLOCK_MONOTONIC, &mt1);
+    run_ooc(board, g, threads_number);
+    rows = board->rows;
+    cols = board->cols;
+    long generation = board->generation;
+    if (opts->view_width) {
+        view_source src = {ooc_bits(board), NULL, rows, cols, {0, rows, 0, cols}};
+        print_view(opts, &src, threads_number, "Final view: ");
+    }
+    if (close_ooc_board(board, &population) != 0) {
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &mt2);
+
+    printf("Final grid: \n%d x %d board at generation %ld, %ld live cells\n\n", rows, cols, generation, population);
+    printf("Elapsed time: %ld", 1000000000 * (mt2.tv_sec - mt1.tv_sec) + (mt2.tv_nsec - mt1.tv_nsec));
+    return 0;
+}
+
+// The batch variant of main: many small random boards instead of one
+// big one. Every thread evolves whole boards, so the number of threads
+// does not have to divide anything.
+int batch_main(options *opts) {
+    int g, rows, cols, threads_number;
+    unsigned int seed;
+    struct timespec mt1, mt2;
+    FILE *out = stdout;
+
+    printf("Welcome to the Multithreaded Game of Life (batch of %ld boards).\n", opts->batch);
+    printf("Enter the height of the boards: ");
+    scanf("%d", &rows);
+    printf("Enter the width of the boards: ");
+    scanf("%d", &cols);
+    printf("Enter the number of generations: ");
+    scanf("%d", &g);
+    printf("Enter the number of threads: ");
+    scanf("%d", &threads_number);
+    printf("Enter the seed of the first board: ");
+    scanf("%u", &seed);
+
+    batch_result *results = malloc(opts->batch * sizeof(batch_result));
+
+    clock_gettime(CLOCK_MONOTONIC, &mt1);
+    run_batch(rows, cols, g, opts->batch, seed, threads_number, opts->fixed, results);
+    clock_gettime(CLOCK_MONOTONIC, &mt2);
+
+    if (opts->output) {
+        out = fopen(opts->output, "w");
+        if (out == NULL) {
+            perror(opts->output);
+            free(results);
+            return 1;
+        }
+    } else {
+        printf("\n");
+    }
+    fprintf(out, "Board;Seed;Population\n");
+    for (long b = 0; b < opts->batch; b++) {
+        fprintf(out, "%ld;%u;%ld\n", b, results[b].seed, results[b].population);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(results);
+
+    printf("\nElapsed time: %ld", 1000000000 * (mt2.tv_sec - mt1.tv_sec) + (mt2.tv_nsec - mt1.tv_nsec));
+    return 0;
+}
+
+// The soup search variant of main: many random soups are run until
+// they settle, and what is left of them is counted.
+int soup_main(options *opts) {
+    int threads_number;
+    unsigned int seed;
+    struct timespec mt1, mt2;
+    soup_summary summary;
+    FILE *out = stdout;
+
+    printf("Welcome to the Multithreaded Game of Life (search of %ld soups).\n", opts->soups);
+    printf("Enter the number of threads: ");
+    scanf("%d", &threads_number);
+    printf("Enter the seed of the first soup: ");
+    scanf("%u", &seed);
+
+    clock_gettime(CLOCK_MONOTONIC, &mt1);
+    search_soups(opts->soups, seed, threads_number, &summary);
+    clock_gettime(CLOCK_MONOTONIC, &mt2);
+    long ns = 1000000000 * (mt2.tv_sec - mt1.tv_sec) + (mt2.tv_nsec - mt1.tv_nsec);
+
+    if (opts->output) {
+        out = fopen(opts->output, "w");
+        if (out == NULL) {
+            perror(opts->output);
+            destroy_census(&summary.objects);
+            return 1;
+        }
+    } else {
+        printf("\n");
+    }
+    write_census(out, &summary.objects);
+    if (out != stdout) {
+        fclose(out);
     }
+    destroy_census(&summary.objects);
+
+    printf("\nSoups: %ld, not settled after %d generations: %ld, objects at the edge: %ld\n",
+           summary.soups, SOUP_MAX_GENERATIONS, summary.unstable, summary.edge_objects);
+    printf("Soups per second: %.0f, generations per soup: %.1f\n",
+           summary.soups / (ns / 1e9), (double)summary.generations / summary.soups);
+    printf("Elapsed time: %ld", ns);
+    return 0;
 }
 
-int main() {
+int main(int argc, char **argv) {
+    options opts;
     int g, rows, cols;
     int threads_number;
     char mode;
+    char path[1024];
+    int row_offset = 0, col_offset = 0;
+    long start = 0;
+    checkpoint_header restored;
+    checkpointer *ckpt = NULL;
+    stream *frames = NULL;
+    FILE *frames_out = NULL;
+    tinfo **thread_infos = NULL;
+    cycle_detector *cycles = NULL;
+    gen_stats *stats = NULL;
+    FILE *stats_out = NULL;
+    tiling *tiles = NULL;
+    int *edges = NULL;
+    grid *window = NULL;
+    history *past = NULL;
+    live_feed *live = NULL;
+    region_set *regions = NULL;
+    const engine_ops *engine_kind = NULL;
+    const transport_ops *transport = NULL;
+    char exchange[256] = "";
     struct timespec mt1, mt2;
     long int timestamp;
 
+    if (parse_options(argc, argv, &opts) != 0) {
+        return 1;
+    }
+    if (opts.ooc) {
+        return out_of_core_main(&opts);
+    }
+    if (opts.batch) {
+        return batch_main(&opts);
+    }
+    if (opts.soups) {
+        return soup_main(&opts);
+    }
+    if (opts.window && (opts.checkpoint || opts.stream || opts.cycles || opts.stats || opts.processes)) {
+        fprintf(stderr, "Checkpoints, streaming, cycle detection, statistics and worker processes need the whole board, not a window.\n");
+        return 1;
+    }
+    if (opts.engine) {
+        if (opts.checkpoint || opts.stream || opts.cycles || opts.stats || opts.processes || opts.window) {
+            fprintf(stderr, "Checkpoints, streaming, cycle detection, statistics, worker processes and windows only work without an engine.\n");
+            return 1;
+        }
+        engine_kind = find_engine(opts.engine);
+        if (engine_kind == NULL) {
+            fprintf(stderr, "Unknown engine '%s', using '%s'.\n", opts.engine, REFERENCE_ENGINE);
+            engine_kind = find_engine(REFERENCE_ENGINE);
+        }
+    }
+    if ((opts.history || opts.live || opts.regions) && (opts.window || opts.engine || opts.processes)) {
+        fprintf(stderr, "The history, live frames and region counts are only recorded by threads, without a window, an engine or worker processes.\n");
+        return 1;
+    }
+    if (opts.in_place && opts.tiles) {
+        fprintf(stderr, "In-place evolution works on row bands only.\n");
+        return 1;
+    }
+    if (opts.processes) {
+        transport = find_transport(opts.transport);
+        if (transport == NULL) {
+            fprintf(stderr, "Unknown transport '%s'.\n", opts.transport);
+            return 1;
+        }
+        if (opts.checkpoint || opts.stream || opts.cycles || opts.stats) {
+            fprintf(stderr, "Checkpoints, streaming, cycle detection and statistics are not available with worker processes.\n");
+            return 1;
+        }
+    }
+
     printf("Welcome to the Multithreaded Game of Life.\n");
-    printf("Enter the height of the board: ");
-    scanf("%d", &rows);
-    printf("Enter the width of the board: ");
-    scanf("%d", &cols);
-    printf("Enter the number of generations: ");
-    scanf("%d", &g);
-    printf("Please enter a divisor of %d to determine the number of threads: ", rows);
+    if (opts.restore) {
+        if (read_checkpoint_header(opts.restore, &restored) != 0) {
+            return 1;
+        }
+        rows = restored.rows;
+        cols = restored.cols;
+        start = (long)restored.generation;
+        printf("Resuming a %d x %d board at generation %ld.\n", rows, cols, start);
+        printf("Enter the generation to run to: ");
+        scanf("%d", &g);
+        g = (g > start) ? (int)(g - start) : 0;
+    } else {
+        printf("Enter the height of the board: ");
+        scanf("%d", &rows);
+        printf("Enter the width of the board: ");
+        scanf("%d", &cols);
+        printf("Enter the number of generations: ");
+        scanf("%d", &g);
+    }
+    printf("Please enter a divisor of %d to determine the number of threads (0 to tune): ", rows);
     scanf("%d", &threads_number);
-    while (rows % threads_number != 0) {
+    while (threads_number < 0 || (threads_number > 0 && rows % threads_number != 0)) {
         printf("I'm sorry, %d does not divide %d. Please choose a divisor of %d: ", threads_number, rows, rows);
         scanf("%d", &threads_number);
     }
+    // 0 threads, or --autotune, takes the fastest configuration for this
+    // size from the tuning cache, tuning the size first if needed.
+    if (threads_number == 0 || opts.autotune) {
+        tune_config configs[TUNE_MAX_CONFIGS];
+        int count = tune_board(opts.tune_cache, rows, cols, opts.autotune, configs);
+        int hooks = opts.checkpoint || opts.stream || opts.cycles || opts.stats || opts.processes || opts.window ||
+                    opts.history || opts.live || opts.regions;
+        const tune_config *best = best_config(configs, count, opts.engine, !hooks && !opts.in_place,
+                                              !opts.in_place && !opts.processes);
+        if (best == NULL) {
+            fprintf(stderr, "No tuned configuration fits this run.\n");
+            return 1;
+        }
+        threads_number = best->threads;
+        if (best->engine[0]) {
+            engine_kind = find_engine(best->engine);
+            if (engine_kind == NULL) engine_kind = find_engine(REFERENCE_ENGINE);
+        } else if (best->tile_rows > 0) {
+            opts.tiles = 1;
+            opts.tile_rows = best->tile_rows;
+            opts.tile_cols = best->tile_cols;
+        } else {
+            opts.tiles = 0;
+        }
+        if (!opts.processes && !engine_kind && rows % threads_number != 0) {
+            threads_number = 1;
+        }
+        printf("Tuned configuration: %d threads, %s.\n", threads_number,
+               best->engine[0] ? best->engine : best->tile_rows > 0 ? "tiles" : "row bands");
+    }
 
-    printf("Please enter grid populating mode ('M' for manual insert and 'R' for random populating): ");
-    scanf(" %c", &mode);
-    while (mode != 'M' && mode != 'R') {
-        printf("I'm sorry, %c is not available input. Please choose correct mode: ", mode);
+    mode = 'C';
+    if (!opts.restore) {
+        printf("Please enter grid populating mode ('M' for manual insert, 'R' for random populating and 'F' for pattern file): ");
         scanf(" %c", &mode);
+        while (mode != 'M' && mode != 'R' && mode != 'F') {
+            printf("I'm sorry, %c is not available input. Please choose correct mode: ", mode);
+            scanf(" %c", &mode);
+        }
+    }
+    if (mode == 'F') {
+        printf("Enter the path to the pattern file (RLE, plaintext or Life 1.06): ");
+        scanf(" %1023[^\n]", path);
+        printf("Enter the row and column offset of the pattern: ");
+        scanf("%d %d", &row_offset, &col_offset);
     }
 
     grid *main = init_grid(rows, cols);
-    grid *temp = init_grid(rows, cols);
-    if (mode == 'R') {
+    // In place the board is evolved without a second grid.
+    grid *temp = opts.in_place ? NULL : init_grid(rows, cols);
+    if (mode == 'C') {
+        if (restore_checkpoint(opts.restore, main, &start, threads_number) != 0) {
+            return 1;
+        }
+    } else if (mode == 'R') {
         random_populate(main, 132 /*(unsigned int) time(NULL)*/);
+    } else if (mode == 'F') {
+        if (load_pattern(main, path, row_offset, col_offset, threads_number) != 0) {
+            return 1;
+        }
     } else {
         manual_populate(main);
     }
-    print_grid(main, "Populated grid at the start of the game: ");
-    update_grid(temp, main, main->rows, 0);
+    // When the final board goes to a file, the start of the game is
+    // only summarized on stdout.
+    write_grid(main, stdout, opts.output ? OUTPUT_SUMMARY : opts.format,
+               "Populated grid at the start of the game: ");
+    if (temp) {
+        update_grid(temp, main, main->rows, 0);
+    }
     // start our profile session
     clock_gettime(CLOCK_MONOTONIC, &mt1);
 
-    barrier_init(&barr, threads_number);
-
-    // Creates an array of tinfo structs and
-    // pthreads. We then place the necessary
-    // info into each tinfo struct.
-    tinfo **thread_infos = malloc(threads_number * sizeof(tinfo));
-    pthread_t threads[threads_number];
+    if (opts.window) {
+        // Only the window's light cone is evolved.
+        window = light_cone(main, opts.window_rect, g);
+        if (window == NULL) {
+            fprintf(stderr, "The window does not lie on the %d x %d board.\n", rows, cols);
+            return 1;
+        }
+    } else if (engine_kind) {
+        engine *E = create_engine(engine_kind, main, threads_number);
+        if (engine_step(E, g) != 0) {
+            fprintf(stderr, "The engine failed.\n");
+            return 1;
+        }
+        engine_export(E, main);
+        snprintf(exchange, sizeof(exchange), "Engine: %s\n", E->ops->name);
+        destroy_engine(E);
+    } else if (opts.processes) {
+        worker_report reports[threads_number];
+        if (run_processes(main, g, threads_number, transport, reports) != 0) {
+            fprintf(stderr, "A worker process failed.\n");
+            return 1;
+        }
+        long total = 0, slowest = 0, busy = 0, bytes = 0;
+        for (int i = 0; i < threads_number; i++) {
+            total += reports[i].exchange_ns;
+            busy += reports[i].exchange_ns + reports[i].compute_ns;
+            bytes += reports[i].bytes;
+            if (reports[i].exchange_ns > slowest) slowest = reports[i].exchange_ns;
+        }
+        snprintf(exchange, sizeof(exchange),
+                 "Halo exchange (%s): %ld ns in total, %ld ns in the slowest worker, %.1f%% of worker time, %ld bytes\n",
+                 transport->name, total, slowest, busy ? 100.0 * total / busy : 0.0, bytes);
+    } else {
+        if (opts.checkpoint) {
+            ckpt = init_checkpointer(opts.checkpoint, opts.checkpoint_every, rows, cols);
+        }
+        if (opts.stats) {
+            gen_stats initial;
+            stats_out = fopen(opts.stats, "w");
+            if (stats_out == NULL) {
+                perror(opts.stats);
+                return 1;
+            }
+            stats = calloc(threads_number, sizeof(gen_stats));
+            grid_stats(main, &initial);
+            write_stats_header(stats_out);
+            write_stats(stats_out, start, &initial);
+        } else if (opts.view_width && !opts.window) {
+            // Only the bounding box is needed, for the view.
+            stats = calloc(threads_number, sizeof(gen_stats));
+        }
+        if (opts.tiles) {
+            int tile_rows = opts.tile_rows, tile_cols = opts.tile_cols;
+            if (tile_rows <= 0 || tile_cols <= 0) {
+                default_tile_shape(&tile_rows, &tile_cols);
+            }
+            tiles = init_tiling(rows, cols, threads_number, tile_rows, tile_cols);
+        }
+        if (opts.in_place) {
+            edges = malloc(2 * (size_t)threads_number * cols * sizeof(int));
+        }
+        if (opts.cycles) {
+            cycles = init_cycle_detector(threads_number, opts.cycle_window,
+                                         opts.cycle_jump ? CYCLE_JUMP : CYCLE_STOP);
+        }
+        if (opts.history) {
+            past = init_history(main, start, threads_number, opts.keyframe_every,
+                                (size_t)opts.history << 20);
+        }
+        if (opts.live) {
+            live = open_live_feed(opts.live, rows, cols, opts.live_every);
+            if (live == NULL) {
+                return 1;
+            }
+        }
+        if (opts.regions) {
+            regions = load_regions(opts.regions, opts.region_counts, rows, cols, threads_number);
+            if (regions == NULL) {
+                return 1;
+            }
+            build_sat(regions->table, main);
+            write_region_counts(regions, start);
+        }
+        if (opts.stream) {
+            frames_out = fopen(opts.stream, "wb");
+            if (frames_out == NULL) {
+                perror(opts.stream);
+                return 1;
+            }
+            frames = init_stream(frames_out, opts.stream_every, opts.stream_frames,
+                                 opts.stream_drop ? STREAM_DROP : STREAM_BLOCK, rows, cols);
+        }
 
-    for (int i = 0; i < threads_number; i++) {
-        thread_infos[i] = init_tinfo();
-        thread_infos[i]->in = main;
-        thread_infos[i]->out = temp;
-        thread_infos[i]->section = i;
-        thread_infos[i]->divide = threads_number;
-        thread_infos[i]->gen = g;
+        // Every thread gets a copy of proto with its own section.
+        tinfo *proto = init_tinfo();
+        proto->in = main;
+        proto->out = temp;
+        proto->gen = g;
+        proto->start = start;
+        proto->ckpt = ckpt;
+        proto->frames = frames;
+        proto->cycles = cycles;
+        proto->stats = stats;
+        proto->stats_out = stats_out;
+        proto->tiles = tiles;
+        proto->edges = edges;
+        proto->past = past;
+        proto->live = live;
+        proto->regions = regions;
+        thread_infos = run_sections(proto, threads_number);
+        free(proto);
     }
 
-    // Initialize a number of threads. Each thread works on a portion of our
-    // grid
-    for (int i = 0; i < threads_number; i++) {
-        pthread_create(&threads[i], NULL, &thread_func, (void *)thread_infos[i]);
+    if (ckpt) {
+        finish_checkpointer(ckpt);
     }
-    for (int i = 0; i < threads_number; i++) {
-        pthread_join(threads[i], NULL);
+    if (frames) {
+        finish_stream(frames);
+        fclose(frames_out);
     }
+    if (stats_out) {
+        fclose(stats_out);
+    }
+    if (live) {
+        close_live_feed(live);
+    }
+    if (regions) {
+        destroy_regions(regions);
+    }
+    if (tiles) {
+        destroy_tiling(tiles);
+    }
+    free(edges);
 
-    barrier_destroy(&barr);
-
-    print_grid(main, "Final grid: ");
+    grid *final = window ? window : main;
+    const char *label = window ? "Final window: " : "Final grid: ";
+    char rewound[64];
+    if (past && opts.rewind >= 0) {
+        if (rewind_history(past, opts.rewind, main) != 0) {
+            fprintf(stderr, "Generation %ld is not in the history, which holds generations %ld to %ld.\n",
+                    opts.rewind, history_first(past), history_last(past));
+            return 1;
+        }
+        snprintf(rewound, sizeof(rewound), "Grid at generation %ld: ", opts.rewind);
+        label = rewound;
+    }
+    if (opts.view_width) {
+        view_source src = {NULL, final, final->rows, final->cols, {0, final->rows, 0, final->cols}};
+        // The sections' statistics bound the last generation evolved,
+        // which is the final board unless it was rewound.
+        if (stats && g > 0 && final == main && label != rewound) {
+            src.live = live_box(stats, threads_number);
+        }
+        print_view(&opts, &src, threads_number, label);
+        if (opts.output) {
+            write_grid(final, stdout, OUTPUT_SUMMARY, label);
+        }
+    } else if (opts.output) {
+        FILE *out = fopen(opts.output, "wb");
+        if (out == NULL) {
+            perror(opts.output);
+        } else {
+            write_grid(final, out, opts.format, label);
+            fclose(out);
+        }
+        write_grid(final, stdout, OUTPUT_SUMMARY, label);
+    } else {
+        write_grid(final, stdout, opts.format, label);
+    }
     clock_gettime (CLOCK_MONOTONIC, &mt2);
 
     timestamp = 1000000000 * (mt2.tv_sec - mt1.tv_sec) + (mt2.tv_nsec - mt1.tv_nsec);
 
+    if (ckpt) {
+        printf("Checkpoints written: %ld (%ld failed), compute stalls: %ld (%ld ns)\n",
+               ckpt->written, ckpt->failed, ckpt->stalls, ckpt->stall_ns);
+        destroy_checkpointer(ckpt);
+    }
+    if (frames) {
+        printf("Frames streamed: %ld, dropped: %ld, backpressure stalls: %ld (%ld ns), %lu of %lu bytes after compression\n",
+               frames->written, frames->dropped, frames->stalls, frames->stall_ns,
+               (unsigned long)frames->compressed_bytes, (unsigned long)frames->raw_bytes);
+        destroy_stream(frames);
+    }
+    if (cycles) {
+        if (cycles->period > 0) {
+            printf("Cycle detected: period %ld from generation %ld, seen at generation %ld, %s generation %ld\n",
+                   cycles->period, cycles->onset, cycles->detected,
+                   cycles->action == CYCLE_JUMP ? "skipped to the result after" : "stopped at",
+                   thread_infos[0]->finished);
+        } else {
+            printf("No cycle of period up to %d found\n", cycles->window);
+        }
+        destroy_cycle_detector(cycles);
+    }
+    if (past) {
+        printf("History: generations %ld to %ld in %d segments, %lu bytes, %ld segments dropped\n",
+               history_first(past), history_last(past), past->segment_count,
+               (unsigned long)past->bytes, past->dropped);
+        destroy_history(past);
+    }
+    printf("%s", exchange);
     printf("Elapsed time: %ld", timestamp);
 
     destroy_grid(main);
-    destroy_grid(temp);
+    free(stats);
+    if (window) {
+        destroy_grid(window);
+    }
+    if (temp) {
+        destroy_grid(temp);
+    }
     free(thread_infos);
 
     return 0;
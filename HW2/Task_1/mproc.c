@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include "mproc.h"
+#include "bitgrid.h"
+#include "bitlife.h"
+
+static long elapsed_ns(struct timespec *from, struct timespec *to) {
+    return 1000000000L * (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec);
+}
+
+// Receives both halo rows of the slab in cur.
+static int exchange_recv(transport *T, int has_up, int has_down, uint64_t *cur, int height, int words) {
+    if (has_up && transport_recv(T, LINK_UP, cur) != 0) return -1;
+    if (has_down && transport_recv(T, LINK_DOWN, cur + (size_t)(height + 1) * words) != 0) return -1;
+    return 0;
+}
+
+// Kills the workers that have not been reaped yet (pid 0).
+static void kill_workers(pid_t *pids, int workers) {
+    for (int i = 0; i < workers; i++) {
+        if (pids[i] > 0) kill(pids[i], SIGTERM);
+    }
+}
+
+// The body of worker k. It owns rows [from, to) of the shared board,
+// keeps them in private memory with one halo row above and below,
+// and swaps halo rows with its neighbours before every generation.
+static int worker_main(uint64_t *board, int rows, int cols, int from, int to, int gens,
+                       transport *T, worker_report *report) {
+    int words = BITGRID_WORDS(cols);
+    int height = to - from;
+    size_t slab = (size_t)(height + 2) * words;
+    uint64_t *cur = calloc(slab, sizeof(uint64_t));
+    uint64_t *next = calloc(slab, sizeof(uint64_t));
+    int has_up = from > 0, has_down = to < rows;
+    int odd = T->worker % 2;
+    struct timespec t1, t2, t3;
+
+    memcpy(cur + words, board + (size_t)from * words, (size_t)height * words * sizeof(uint64_t));
+
+    for (int g = 0; g < gens; g++) {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        // Even workers send first and odd ones receive first, so a
+        // send never has to fit into whatever the link buffers: its
+        // reader is already waiting for it or gets to it without
+        // sending anything itself.
+        if (odd && exchange_recv(T, has_up, has_down, cur, height, words) != 0) return 1;
+        if (has_up && transport_send(T, LINK_UP, cur + words) != 0) return 1;
+        if (has_down && transport_send(T, LINK_DOWN, cur + (size_t)height * words) != 0) return 1;
+        if (!odd && exchange_recv(T, has_up, has_down, cur, height, words) != 0) return 1;
+        report->bytes += (has_up + has_down) * T->row_bytes;
+
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        for (int i = 1; i <= height; i++) {
+            evolve_packed_row((i > 1 || has_up) ? cur + (size_t)(i - 1) * words : NULL,
+                              cur + (size_t)i * words,
+                              (i < height || has_down) ? cur + (size_t)(i + 1) * words : NULL,
+                              next + (size_t)i * words, cols);
+        }
+        uint64_t *tmp = cur;
+        cur = next;
+        next = tmp;
+        clock_gettime(CLOCK_MONOTONIC, &t3);
+
+        report->exchange_ns += elapsed_ns(&t1, &t2);
+        report->compute_ns += elapsed_ns(&t2, &t3);
+    }
+
+    memcpy(board + (size_t)from * words, cur + words, (size_t)height * words * sizeof(uint64_t));
+    free(cur);
+    free(next);
+    return 0;
+}
+
+// Evolves G for gens generations with the given number of worker
+// processes, each owning a horizontal slab. The board travels to and
+// from the workers through a shared mapping; halo rows go through the
+// transport. reports receives one entry per worker.
+// Returns 0 on success and -1 if a worker failed.
+int run_processes(grid *G, int gens, int workers, const transport_ops *ops, worker_report *reports) {
+    int words = BITGRID_WORDS(G->cols);
+    size_t board_size = (size_t)G->rows * words * sizeof(uint64_t);
+    size_t reports_size = workers * sizeof(worker_report);
+    int status = 0;
+
+    char *shared = mmap(NULL, board_size + reports_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    uint64_t *board = (uint64_t *)shared;
+    worker_report *shared_reports = (worker_report *)(shared + board_size);
+    memset(shared_reports, 0, reports_size);
+    pack_rows(board, G, 0, G->rows);
+
+    transport *T = create_transport(ops, workers, words * sizeof(uint64_t));
+    if (T == NULL) {
+        munmap(shared, board_size + reports_size);
+        return -1;
+    }
+
+    // Whatever stdio still buffers would be flushed once per child.
+    fflush(NULL);
+    pid_t parent = getpid();
+    pid_t pids[workers];
+    for (int k = 0; k < workers; k++) {
+        pids[k] = fork();
+        if (pids[k] == 0) {
+            // A worker must not outlive the parent, which is the only
+            // one that can tell the others to give up.
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (getppid() != parent) _exit(1);
+            attach_transport(T, k);
+            int code = worker_main(board, G->rows, G->cols,
+                                   (int)((long)G->rows * k / workers),
+                                   (int)((long)G->rows * (k + 1) / workers),
+                                   gens, T, &shared_reports[k]);
+            _exit(code);
+        }
+        if (pids[k] < 0) {
+            // The workers already running would wait for their missing
+            // neighbours forever.
+            perror("fork");
+            kill_workers(pids, k);
+            status = -1;
+            workers = k;
+            break;
+        }
+    }
+
+    // Workers are reaped in whatever order they end. Once one of them
+    // fails, its neighbours would wait for its rows forever (the shared
+    // memory rings cannot tell a dead peer from a slow one), so the
+    // whole group is stopped.
+    for (int remaining = workers; remaining > 0; remaining--) {
+        int code, k;
+        pid_t pid = waitpid(-1, &code, 0);
+        if (pid < 0) break;
+        for (k = 0; k < workers && pids[k] != pid; k++) {
+        }
+        if (k == workers) {
+            remaining++;
+            continue;
+        }
+        pids[k] = 0;
+        if (!WIFEXITED(code) || WEXITSTATUS(code) != 0) {
+            if (status == 0) kill_workers(pids, workers);
+            status = -1;
+        }
+    }
+    destroy_transport(T);
+
+    if (status == 0) {
+        unpack_rows(G, board, 0, G->rows);
+        memcpy(reports, shared_reports, reports_size);
+    }
+    munmap(shared, board_size + reports_size);
+    return status;
+}
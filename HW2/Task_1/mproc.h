@@ -0,0 +1,16 @@
+#include "grid.h"
+#include "transport.h"
+
+#ifndef _MPROC_H
+#define _MPROC_H
+
+// Per-worker numbers collected after a multi-process run.
+typedef struct {
+    long exchange_ns;           // time spent sending and receiving halos
+    long compute_ns;            // time spent evolving the slab
+    long bytes;                 // halo bytes sent
+} worker_report;
+
+int run_processes(grid *G, int gens, int workers, const transport_ops *ops, worker_report *reports);
+
+#endif
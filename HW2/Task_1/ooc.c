@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ooc.h"
+#include "bitlife.h"
+#include "barrier.h"
+#include "checkpoint.h"
+
+// Rows are streamed in bands of roughly this many bytes: big enough
+// for the read-ahead to reach disk bandwidth, small enough that a few
+// bands per thread fit into memory comfortably.
+#define BAND_BYTES (8 << 20)
+
+typedef struct {
+    ooc_board *B;
+    int from, to;               // rows owned by the thread
+    int gens;
+    unsigned int seed;
+    barrier *barr;
+} ooc_job;
+
+static uint64_t *payload(ooc_board *B, int map) {
+    return (uint64_t *)(B->map[map] + CHECKPOINT_PAYLOAD_OFFSET);
+}
+
+static uint64_t *row_at(ooc_board *B, int map, int row) {
+    return payload(B, map) + (size_t)row * B->words;
+}
+
+// Applies advice to the pages holding rows [from, to) of a map.
+static void advise_rows(ooc_board *B, int map, int from, int to, int advice) {
+    static long page = 0;
+    if (page == 0) page = sysconf(_SC_PAGESIZE);
+    if (from < 0) from = 0;
+    if (to > B->rows) to = B->rows;
+    if (from >= to) return;
+
+    uintptr_t begin = (uintptr_t)row_at(B, map, from);
+    uintptr_t end = (uintptr_t)row_at(B, map, to);
+    begin &= ~(uintptr_t)(page - 1);
+    madvise((void *)begin, end - begin, advice);
+}
+
+int ooc_board_exists(const char *path) {
+    return access(path, F_OK) == 0;
+}
+
+static char *map_file(const char *path, size_t size, int create) {
+    int fd = open(path, create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    if (create && ftruncate(fd, size) != 0) {
+        perror(path);
+        close(fd);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < size) {
+        fprintf(stderr, "%s is truncated.\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+    return map;
+}
+
+// splitmix64, used to seed every row independently so the threads
+// can populate their rows in parallel.
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Fills rows [from, to) with a random soup, every cell being alive
+// with probability 1/3 like in random_populate.
+static void populate_rows(ooc_board *B, int from, int to, unsigned int seed) {
+    for (int i = from; i < to; i++) {
+        uint64_t state = ((uint64_t)seed << 32) ^ (uint64_t)i;
+        uint64_t *row = row_at(B, B->current, i);
+
+        for (int w = 0; w < B->words; w++) {
+            uint64_t word = 0;
+            for (int k = 0; k < 64; k += 2) {
+                uint64_t r = next_random(&state);
+                // Two cells per random number, each from 32 bits.
+                word |= (uint64_t)(((r & 0xffffffffu) * 3) >> 32 == 0) << k;
+                word |= (uint64_t)(((r >> 32) * 3) >> 32 == 0) << (k + 1);
+            }
+            row[w] = word;
+        }
+        if (B->cols % 64) {
+            row[B->words - 1] &= (UINT64_C(1) << (B->cols % 64)) - 1;
+        }
+        if ((i - from) % B->band_rows == B->band_rows - 1) {
+            advise_rows(B, B->current, i + 1 - B->band_rows, i + 1, MADV_DONTNEED);
+        }
+    }
+}
+
+static void *populate_func(void *arguments) {
+    ooc_job *job = (ooc_job *)arguments;
+    populate_rows(job->B, job->from, job->to, job->seed);
+    return NULL;
+}
+
+// Streams the thread's rows through the kernel for every generation.
+// While a band is being computed the next one is prefetched, and the
+// band before it is dropped from memory once it has been used.
+static void *ooc_thread_func(void *arguments) {
+    ooc_job *job = (ooc_job *)arguments;
+    ooc_board *B = job->B;
+    int band = B->band_rows;
+
+    for (int g = 0; g < job->gens; g++) {
+        int src = B->current, dst = !src;
+
+        advise_rows(B, src, job->from - 1, job->from + band + 1, MADV_WILLNEED);
+        for (int start = job->from; start < job->to; start += band) {
+            int end = start + band < job->to ? start + band : job->to;
+
+            advise_rows(B, src, end + 1, end + band + 1, MADV_WILLNEED);
+            advise_rows(B, dst, end, end + band, MADV_WILLNEED);
+
+            for (int i = start; i < end; i++) {
+                evolve_packed_row(i > 0 ? row_at(B, src, i - 1) : NULL,
+                                  row_at(B, src, i),
+                                  i + 1 < B->rows ? row_at(B, src, i + 1) : NULL,
+                                  row_at(B, dst, i), B->cols);
+            }
+
+            // The last source row of the band is still needed as the
+            // upper neighbour of the next band.
+            advise_rows(B, src, start - 1, end - 1, MADV_DONTNEED);
+            advise_rows(B, dst, start, end, MADV_DONTNEED);
+        }
+
+        // Every thread has to finish the generation before anybody
+        // starts overwriting the old one.
+        barrier_wait(job->barr);
+        if (job->from == 0) {
+            B->current = dst;
+            B->generation++;
+        }
+        barrier_wait(job->barr);
+    }
+    return NULL;
+}
+
+static void run_jobs(ooc_board *B, int threads, int gens, unsigned int seed, void *(*func)(void *)) {
+    ooc_job jobs[threads];
+    pthread_t workers[threads];
+    barrier barr;
+
+    barrier_init(&barr, threads);
+    for (int i = 0; i < threads; i++) {
+        jobs[i].B = B;
+        jobs[i].from = (int)((long)B->rows * i / threads);
+        jobs[i].to = (int)((long)B->rows * (i + 1) / threads);
+        jobs[i].gens = gens;
+        jobs[i].seed = seed;
+        jobs[i].barr = &barr;
+        pthread_create(&workers[i], NULL, func, (void *)&jobs[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    barrier_destroy(&barr);
+}
+
+// Opens the out-of-core board at path. If path already holds a
+// checkpoint the board is resumed from it and rows/cols are ignored;
+// otherwise a new rows x cols board is created and filled with a
+// random soup. Returns NULL if the files cannot be set up.
+ooc_board *open_ooc_board(const char *path, int rows, int cols, unsigned int seed, int threads) {
+    checkpoint_header header;
+    int resume = ooc_board_exists(path);
+
+    if (resume) {
+        if (read_checkpoint_header(path, &header) != 0) return NULL;
+        rows = header.rows;
+        cols = header.cols;
+    }
+
+    ooc_board *B = (ooc_board *)calloc(1, sizeof(ooc_board));
+    snprintf(B->path, sizeof(B->path), "%s", path);
+    snprintf(B->next_path, sizeof(B->next_path), "%s.next", path);
+    B->rows = rows;
+    B->cols = cols;
+    B->words = (cols + 63) / 64;
+    B->map_size = CHECKPOINT_PAYLOAD_OFFSET + (size_t)rows * B->words * sizeof(uint64_t);
+    B->band_rows = BAND_BYTES / (B->words * sizeof(uint64_t));
+    if (B->band_rows < 1) B->band_rows = 1;
+    B->generation = resume ? (long)header.generation : 0;
+
+    B->map[0] = map_file(path, B->map_size, !resume);
+    B->map[1] = map_file(B->next_path, B->map_size, 1);
+    if (B->map[0] == NULL || B->map[1] == NULL) {
+        if (B->map[0]) munmap(B->map[0], B->map_size);
+        if (B->map[1]) munmap(B->map[1], B->map_size);
+        free(B);
+        return NULL;
+    }
+
+    // A run that died half way leaves the old header over a payload
+    // that was partly overwritten, so a resumed board has to match
+    // its checksum before it is evolved any further.
+    if (resume) {
+        size_t words = (size_t)rows * B->words;
+        if (header.payload_offset != CHECKPOINT_PAYLOAD_OFFSET ||
+            header.payload_size != words * sizeof(uint64_t) ||
+            checkpoint_checksum(payload(B, 0), words) != header.checksum) {
+            fprintf(stderr, "%s is corrupt (checksum mismatch), not resuming it.\n", path);
+            munmap(B->map[0], B->map_size);
+            munmap(B->map[1], B->map_size);
+            unlink(B->next_path);
+            free(B);
+            return NULL;
+        }
+    } else {
+        run_jobs(B, threads, 0, seed, &populate_func);
+    }
+    return B;
+}
+
+// Advances the board by gens generations using the given number of
+// threads, each streaming through its own horizontal slab.
+void run_ooc(ooc_board *B, int gens, int threads) {
+    run_jobs(B, threads, gens, 0, &ooc_thread_func);
+}
+
+// The packed current generation, valid until the board is closed.
+const uint64_t *ooc_bits(ooc_board *B) {
+    return payload(B, B->current);
+}
+
+// Seals the current generation as a checkpoint at the board's path,
+// removes the scratch file and unmaps everything. The population of
+// the final board is stored in *population.
+int close_ooc_board(ooc_board *B, long *population) {
+    size_t words = (size_t)B->rows * B->words;
+    const uint64_t *bits = payload(B, B->current);
+    checkpoint_header header;
+    long count = 0;
+    int status = 0;
+
+    madvise(B->map[B->current], B->map_size, MADV_SEQUENTIAL);
+    for (size_t i = 0; i < words; i++) {
+        count += __builtin_popcountll(bits[i]);
+    }
+    *population = count;
+
+    fill_checkpoint_header(&header, B->rows, B->cols, B->generation, bits);
+    memcpy(B->map[B->current], &header, sizeof(header));
+
+    if (msync(B->map[B->current], B->map_size, MS_SYNC) != 0) {
+        perror(B->current ? B->next_path : B->path);
+        status = -1;
+    }
+    munmap(B->map[0], B->map_size);
+    munmap(B->map[1], B->map_size);
+
+    if (B->current == 1 && rename(B->next_path, B->path) != 0) {
+        perror(B->path);
+        status = -1;
+    } else if (B->current == 0) {
+        unlink(B->next_path);
+    }
+    free(B);
+    return status;
+}
@@ -0,0 +1,31 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef _OOC_H
+#define _OOC_H
+
+// ooc_board is a board that lives in a file instead of RAM. The file
+// is a regular checkpoint (see checkpoint.h), so it can be restored
+// or resumed later; a second file next to it (path + ".next") holds
+// the generation being computed. Both are memory-mapped and only the
+// band of rows a thread is working on has to be resident.
+typedef struct {
+    char path[1024];
+    char next_path[1040];
+    int rows;
+    int cols;
+    int words;                  // 64-bit words per row
+    size_t map_size;
+    char *map[2];               // [0] is path, [1] is next_path
+    int current;                // map holding the current generation
+    int band_rows;              // rows processed between prefetches
+    long generation;
+} ooc_board;
+
+ooc_board *open_ooc_board(const char *path, int rows, int cols, unsigned int seed, int threads);
+int ooc_board_exists(const char *path);
+void run_ooc(ooc_board *B, int gens, int threads);
+const uint64_t *ooc_bits(ooc_board *B);
+int close_ooc_board(ooc_board *B, long *population);
+
+#endif
@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "options.h"
+
+// Long options without a short form.
+enum {
+    OPT_STREAM_FRAMES = 256,
+    OPT_STREAM_DROP,
+    OPT_CYCLE_WINDOW,
+    OPT_TILE,
+    OPT_IN_PLACE,
+    OPT_FIXED,
+    OPT_AUTOTUNE,
+    OPT_TUNE_CACHE,
+    OPT_HISTORY,
+    OPT_KEYFRAME_EVERY,
+    OPT_REWIND,
+    OPT_VIEW,
+    OPT_VIEW_FORMAT,
+    OPT_LIVE,
+    OPT_LIVE_EVERY,
+    OPT_REGIONS,
+    OPT_REGION_COUNTS,
+    OPT_SOUPS
+};
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -f, --format FORMAT   board format: text, plain, rle, pbm or summary\n"
+            "  -o, --output PATH     write the final board to PATH\n"
+            "  -c, --checkpoint PATH save a checkpoint to PATH in the background\n"
+            "  -k, --checkpoint-every N\n"
+            "                        generations between checkpoints (default 1000)\n"
+            "  -r, --restore PATH    resume from the checkpoint at PATH\n"
+            "  -s, --stream PATH     stream intermediate generations to PATH\n"
+            "  -e, --stream-every N  generations between streamed frames (default 1)\n"
+            "      --stream-frames N number of frame buffers (default 4)\n"
+            "      --stream-drop     drop frames instead of waiting for the writer\n"
+            "  -O, --out-of-core PATH\n"
+            "                        keep the board packed in PATH instead of memory\n"
+            "  -P, --processes       use worker processes instead of threads\n"
+            "  -t, --transport NAME  halo transport between processes: shm or socket\n"
+            "  -y, --cycles ACTION   on a repeating board 'stop' or 'jump' to the result\n"
+            "      --cycle-window N  longest period to look for (default 16)\n"
+            "  -S, --stats PATH      write population, births, deaths and bounding box\n"
+            "                        of every generation to PATH\n"
+            "  -l, --layout LAYOUT   work split: bands (rows per thread) or tiles\n"
+            "      --tile RxC        tile shape for the tiles layout (default from caches)\n"
+            "      --in-place        evolve row bands in place instead of using a second grid\n"
+            "  -w, --window R,C,HxW  only compute the H x W window at row R, column C\n"
+            "                        of the final board from its light cone\n"
+            "  -B, --batch N         evolve N small random boards instead of one board\n"
+            "      --fixed-size      use the compile-time specialized batch kernels\n"
+            "                        for 32x32, 64x64 and 128x128 boards\n"
+            "  -E, --engine NAME     evolve with an engine: naive, sliding, bitpacked\n"
+            "                        or dataflow\n"
+            "      --autotune        time threads, tiles and engines for this board size,\n"
+            "                        save the results and run with the fastest\n"
+            "      --tune-cache PATH tuning cache used when 0 threads are entered\n"
+            "                        (default tuning.csv)\n"
+            "      --history MB      keep every generation in at most MB megabytes,\n"
+            "                        dropping the oldest ones first\n"
+            "      --keyframe-every N\n"
+            "                        generations between full boards in the history\n"
+            "                        (default 64)\n"
+            "      --rewind G        print generation G from the history instead of\n"
+            "                        the final board (keeps 64 MB unless --history)\n"
+            "      --view WxH        print the final board shrunk to W x H pixels,\n"
+            "                        each showing the density of its block of cells\n"
+            "      --view-format FORMAT\n"
+            "                        view format: ascii or pgm (default ascii)\n"
+            "      --live NAME       publish the board to the shared memory NAME\n"
+            "                        (like /gol) for Viewer while running\n"
+            "      --live-every N    generations between published frames (default 10)\n"
+            "      --regions PATH    count the live cells of the rectangles in PATH,\n"
+            "                        one R,C,HxW per line, in every generation\n"
+            "      --region-counts PATH\n"
+            "                        file for the counts (default regions.csv)\n"
+            "      --soups N         run N random soups until they settle and count\n"
+            "                        the still lifes and oscillators left over\n"
+            "  -h, --help            show this message\n",
+            program);
+}
+
+// Fills opts from the command line. Returns 0 on success and -1 if
+// the arguments are invalid (usage has been printed by then).
+int parse_options(int argc, char **argv, options *opts) {
+    static const struct option long_options[] = {
+        {"format", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {"checkpoint", required_argument, NULL, 'c'},
+        {"checkpoint-every", required_argument, NULL, 'k'},
+        {"restore", required_argument, NULL, 'r'},
+        {"stream", required_argument, NULL, 's'},
+        {"stream-every", required_argument, NULL, 'e'},
+        {"stream-frames", required_argument, NULL, OPT_STREAM_FRAMES},
+        {"stream-drop", no_argument, NULL, OPT_STREAM_DROP},
+        {"out-of-core", required_argument, NULL, 'O'},
+        {"processes", no_argument, NULL, 'P'},
+        {"transport", required_argument, NULL, 't'},
+        {"cycles", required_argument, NULL, 'y'},
+        {"cycle-window", required_argument, NULL, OPT_CYCLE_WINDOW},
+        {"stats", required_argument, NULL, 'S'},
+        {"layout", required_argument, NULL, 'l'},
+        {"tile", required_argument, NULL, OPT_TILE},
+        {"in-place", no_argument, NULL, OPT_IN_PLACE},
+        {"window", required_argument, NULL, 'w'},
+        {"batch", required_argument, NULL, 'B'},
+        {"fixed-size", no_argument, NULL, OPT_FIXED},
+        {"engine", required_argument, NULL, 'E'},
+        {"autotune", no_argument, NULL, OPT_AUTOTUNE},
+        {"tune-cache", required_argument, NULL, OPT_TUNE_CACHE},
+        {"history", required_argument, NULL, OPT_HISTORY},
+        {"keyframe-every", required_argument, NULL, OPT_KEYFRAME_EVERY},
+        {"rewind", required_argument, NULL, OPT_REWIND},
+        {"view", required_argument, NULL, OPT_VIEW},
+        {"view-format", required_argument, NULL, OPT_VIEW_FORMAT},
+        {"live", required_argument, NULL, OPT_LIVE},
+        {"live-every", required_argument, NULL, OPT_LIVE_EVERY},
+        {"regions", required_argument, NULL, OPT_REGIONS},
+        {"region-counts", required_argument, NULL, OPT_REGION_COUNTS},
+        {"soups", required_argument, NULL, OPT_SOUPS},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    int c;
+
+    opts->format = OUTPUT_TEXT;
+    opts->output = NULL;
+    opts->checkpoint = NULL;
+    opts->checkpoint_every = 1000;
+    opts->restore = NULL;
+    opts->stream = NULL;
+    opts->stream_every = 1;
+    opts->stream_frames = 4;
+    opts->stream_drop = 0;
+    opts->ooc = NULL;
+    opts->processes = 0;
+    opts->transport = "shm";
+    opts->cycles = 0;
+    opts->cycle_jump = 0;
+    opts->cycle_window = 16;
+    opts->stats = NULL;
+    opts->tiles = 0;
+    opts->tile_rows = 0;
+    opts->tile_cols = 0;
+    opts->in_place = 0;
+    opts->window = 0;
+    opts->batch = 0;
+    opts->fixed = 0;
+    opts->engine = NULL;
+    opts->autotune = 0;
+    opts->tune_cache = "tuning.csv";
+    opts->history = 0;
+    opts->keyframe_every = 64;
+    opts->rewind = -1;
+    opts->view_width = 0;
+    opts->view_height = 0;
+    opts->view_format = VIEW_ASCII;
+    opts->live = NULL;
+    opts->live_every = 10;
+    opts->regions = NULL;
+    opts->region_counts = "regions.csv";
+    opts->soups = 0;
+
+    while ((c = getopt_long(argc, argv, "f:o:c:k:r:s:e:O:Pt:y:S:l:w:B:E:h", long_options, NULL)) != -1) {
+        switch (c) {
+            case 'f':
+                if (parse_output_format(optarg, &opts->format) != 0) {
+                    fprintf(stderr, "Unknown board format '%s'.\n", optarg);
+                    usage(argv[0]);
+                    return -1;
+                }
+                break;
+            case 'o':
+                opts->output = optarg;
+                break;
+            case 'c':
+                opts->checkpoint = optarg;
+                break;
+            case 'k':
+                opts->checkpoint_every = atoi(optarg);
+                if (opts->checkpoint_every <= 0) {
+                    fprintf(stderr, "The checkpoint interval must be positive.\n");
+                    return -1;
+                }
+                break;
+            case 'r':
+                opts->restore = optarg;
+                break;
+            case 's':
+                opts->stream = optarg;
+                break;
+            case 'e':
+                opts->stream_every = atoi(optarg);
+                if (opts->stream_every <= 0) {
+                    fprintf(stderr, "The stream interval must be positive.\n");
+                    return -1;
+                }
+                break;
+            case OPT_STREAM_FRAMES:
+                opts->stream_frames = atoi(optarg);
+                if (opts->stream_frames <= 0) {
+                    fprintf(stderr, "The frame pool needs at least one frame.\n");
+                    return -1;
+                }
+                break;
+            case OPT_STREAM_DROP:
+                opts->stream_drop = 1;
+                break;
+            case 'O':
+                opts->ooc = optarg;
+                break;
+            case 'P':
+                opts->processes = 1;
+                break;
+            case 't':
+                opts->transport = optarg;
+                break;
+            case 'y':
+                if (strcmp(optarg, "stop") != 0 && strcmp(optarg, "jump") != 0) {
+                    fprintf(stderr, "The cycle action must be 'stop' or 'jump'.\n");
+                    return -1;
+                }
+                opts->cycles = 1;
+                opts->cycle_jump = strcmp(optarg, "jump") == 0;
+                break;
+            case 'S':
+                opts->stats = optarg;
+                break;
+            case 'l':
+                if (strcmp(optarg, "bands") != 0 && strcmp(optarg, "tiles") != 0) {
+                    fprintf(stderr, "The layout must be 'bands' or 'tiles'.\n");
+                    return -1;
+                }
+                opts->tiles = strcmp(optarg, "tiles") == 0;
+                break;
+            case OPT_TILE:
+                if (sscanf(optarg, "%dx%d", &opts->tile_rows, &opts->tile_cols) != 2 ||
+                    opts->tile_rows <= 0 || opts->tile_cols <= 0) {
+                    fprintf(stderr, "The tile shape must look like 64x1024.\n");
+                    return -1;
+                }
+                break;
+            case 'w': {
+                int r, c, h, w;
+                if (sscanf(optarg, "%d,%d,%dx%d", &r, &c, &h, &w) != 4 ||
+                    r < 0 || c < 0 || h <= 0 || w <= 0) {
+                    fprintf(stderr, "The window must look like 100,200,16x32.\n");
+                    return -1;
+                }
+                opts->window = 1;
+                opts->window_rect.r0 = r;
+                opts->window_rect.r1 = r + h;
+                opts->window_rect.c0 = c;
+                opts->window_rect.c1 = c + w;
+                break;
+            }
+            case 'B':
+                opts->batch = atol(optarg);
+                if (opts->batch <= 0) {
+                    fprintf(stderr, "The batch needs at least one board.\n");
+                    return -1;
+                }
+                break;
+            case 'E':
+                opts->engine = optarg;
+                break;
+            case OPT_AUTOTUNE:
+                opts->autotune = 1;
+                break;
+            case OPT_TUNE_CACHE:
+                opts->tune_cache = optarg;
+                break;
+            case OPT_HISTORY:
+                opts->history = atol(optarg);
+                if (opts->history <= 0) {
+                    fprintf(stderr, "The history needs a positive budget.\n");
+                    return -1;
+                }
+                break;
+            case OPT_KEYFRAME_EVERY:
+                opts->keyframe_every = atoi(optarg);
+                if (opts->keyframe_every <= 0) {
+                    fprintf(stderr, "The keyframe interval must be positive.\n");
+                    return -1;
+                }
+                break;
+            case OPT_REWIND:
+                opts->rewind = atol(optarg);
+                if (opts->rewind < 0) {
+                    fprintf(stderr, "The generation to rewind to cannot be negative.\n");
+                    return -1;
+                }
+                break;
+            case OPT_VIEW:
+                if (sscanf(optarg, "%dx%d", &opts->view_width, &opts->view_height) != 2 ||
+                    opts->view_width <= 0 || opts->view_height <= 0) {
+                    fprintf(stderr, "The view size must look like 200x60.\n");
+                    return -1;
+                }
+                break;
+            case OPT_VIEW_FORMAT:
+                if (parse_view_format(optarg, &opts->view_format) != 0) {
+                    fprintf(stderr, "The view format must be 'ascii' or 'pgm'.\n");
+                    return -1;
+                }
+                break;
+            case OPT_LIVE:
+                opts->live = optarg;
+                break;
+            case OPT_LIVE_EVERY:
+                opts->live_every = atoi(optarg);
+                if (opts->live_every <= 0) {
+                    fprintf(stderr, "The live frame interval must be positive.\n");
+                    return -1;
+                }
+                break;
+            case OPT_REGIONS:
+                opts->regions = optarg;
+                break;
+            case OPT_REGION_COUNTS:
+                opts->region_counts = optarg;
+                break;
+            case OPT_SOUPS:
+                opts->soups = atol(optarg);
+                if (opts->soups <= 0) {
+                    fprintf(stderr, "The search needs at least one soup.\n");
+                    return -1;
+                }
+                break;
+            case OPT_FIXED:
+                opts->fixed = 1;
+                break;
+            case OPT_IN_PLACE:
+                opts->in_place = 1;
+                break;
+            case OPT_CYCLE_WINDOW:
+                opts->cycle_window = atoi(optarg);
+                if (opts->cycle_window <= 0) {
+                    fprintf(stderr, "The cycle window must be positive.\n");
+                    return -1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return -1;
+        }
+    }
+    if (opts->rewind >= 0 && opts->history == 0) {
+        opts->history = 64;
+    }
+    if (optind < argc) {
+        usage(argv[0]);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "output.h"
+#include "tiling.h"
+#include "view.h"
+
+#ifndef _OPTIONS_H
+#define _OPTIONS_H
+
+// options holds the command line settings. Everything that is not
+// given on the command line keeps the interactive behaviour of the
+// original program.
+typedef struct {
+    output_format format;   // format of the printed boards
+    const char *output;     // file for the final board, NULL for stdout
+    const char *checkpoint; // checkpoint file, NULL if disabled
+    int checkpoint_every;   // generations between checkpoints
+    const char *restore;    // checkpoint to resume from, NULL if none
+    const char *stream;     // frame stream file, NULL if disabled
+    int stream_every;       // generations between streamed frames
+    int stream_frames;      // size of the frame buffer pool
+    int stream_drop;        // drop frames instead of waiting for the writer
+    const char *ooc;        // file backing an out-of-core board, NULL if in memory
+    int processes;          // run worker processes instead of threads
+    const char *transport;  // halo transport between worker processes
+    int cycles;             // watch for repeating boards
+    int cycle_jump;         // skip to the result instead of stopping
+    int cycle_window;       // longest period looked for
+    const char *stats;      // per-generation statistics file, NULL if disabled
+    int tiles;              // evolve cache-sized 2D tiles instead of row bands
+    int tile_rows;          // tile shape, 0 to derive it from the caches
+    int tile_cols;
+    int in_place;           // evolve the board without a second grid
+    int window;             // only compute window_rect of the final board
+    tile window_rect;
+    long batch;             // number of boards in batch mode, 0 for one board
+    int fixed;              // batch kernels specialized for the board size
+    const char *engine;     // engine to evolve the board with, NULL for thread sections
+    int autotune;           // time the candidate configurations again
+    const char *tune_cache; // file with the tuned configurations
+    long history;           // memory budget of the history in MB, 0 if disabled
+    int keyframe_every;     // generations between keyframes of the history
+    long rewind;            // generation to print instead of the last, -1 for none
+    int view_width;         // size of the downsampled view of the final board,
+    int view_height;        // 0 to print every cell
+    view_format view_format;
+    const char *live;       // shared memory name to publish frames under, NULL if disabled
+    int live_every;         // generations between published frames
+    const char *regions;    // rectangles to count every generation, NULL if none
+    const char *region_counts; // file for their populations
+    long soups;             // number of soups to search, 0 for one board
+} options;
+
+int parse_options(int argc, char **argv, options *opts);
+
+#endif
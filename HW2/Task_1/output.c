@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "output.h"
+
+// Rows are formatted into a buffer of this size and handed to
+// the stream in one go, so the stream sees a handful of huge
+// writes instead of one call per cell.
+#define OUTBUF_SIZE (1 << 20)
+
+// RLE lines are wrapped at this width, as most tools expect.
+#define RLE_LINE 70
+
+typedef struct {
+    FILE *stream;
+    char *buf;
+    size_t len;
+    size_t size;
+    int line;               // length of the current RLE line
+} outbuf;
+
+static void flush_outbuf(outbuf *O) {
+    if (O->len > 0) {
+        fwrite(O->buf, 1, O->len, O->stream);
+        O->len = 0;
+    }
+}
+
+// Makes sure at least n more bytes fit into the buffer.
+static char *reserve(outbuf *O, size_t n) {
+    if (O->len + n > O->size) {
+        flush_outbuf(O);
+        if (n > O->size) {
+            O->buf = realloc(O->buf, n);
+            O->size = n;
+        }
+    }
+    return O->buf + O->len;
+}
+
+static void put_str(outbuf *O, const char *s) {
+    size_t n = strlen(s);
+    memcpy(reserve(O, n), s, n);
+    O->len += n;
+}
+
+int parse_output_format(const char *name, output_format *format) {
+    static const struct {
+        const char *name;
+        output_format format;
+    } names[] = {
+        {"text", OUTPUT_TEXT},
+        {"plain", OUTPUT_PLAINTEXT},
+        {"rle", OUTPUT_RLE},
+        {"pbm", OUTPUT_PBM},
+        {"summary", OUTPUT_SUMMARY},
+    };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(name, names[i].name) == 0) {
+            *format = names[i].format;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+long count_population(grid *G) {
+    long population = 0;
+    for (int i = 0; i < G->rows; i++) {
+        const int *row = G->val[i];
+        for (int j = 0; j < G->cols; j++) {
+            population += row[j];
+        }
+    }
+    return population;
+}
+
+// Formats every row as one character per cell. These loops have no
+// branches, so the compiler turns them into vector code.
+static void write_chars(outbuf *O, grid *G, char dead, char alive) {
+    for (int i = 0; i < G->rows; i++) {
+        const int *row = G->val[i];
+        char *dst = reserve(O, G->cols + 1);
+        for (int j = 0; j < G->cols; j++) {
+            dst[j] = row[j] ? alive : dead;
+        }
+        dst[G->cols] = '\n';
+        O->len += G->cols + 1;
+    }
+}
+
+// Appends one RLE token, wrapping the line when it gets too long.
+static void put_run(outbuf *O, long count, char tag) {
+    char token[24];
+    int n = (count > 1) ? snprintf(token, sizeof(token), "%ld%c", count, tag)
+                        : snprintf(token, sizeof(token), "%c", tag);
+
+    if (O->line + n > RLE_LINE) {
+        *reserve(O, 1) = '\n';
+        O->len++;
+        O->line = 0;
+    }
+    memcpy(reserve(O, n), token, n);
+    O->len += n;
+    O->line += n;
+}
+
+static void write_rle(outbuf *O, grid *G) {
+    char header[96];
+    long pending_rows = 0;
+
+    snprintf(header, sizeof(header), "x = %d, y = %d, rule = B3/S23\n", G->cols, G->rows);
+    put_str(O, header);
+    O->line = 0;
+
+    for (int i = 0; i < G->rows; i++) {
+        const int *row = G->val[i];
+
+        // Trailing dead cells of a row are never written, and empty
+        // rows are folded into the count of the next '$'.
+        int last = G->cols;
+        while (last > 0 && !row[last - 1]) last--;
+        if (last == 0) {
+            pending_rows++;
+            continue;
+        }
+        // The first written row only needs the skipped rows above it,
+        // every later one also ends the row written before.
+        long breaks = (pending_rows < i) ? pending_rows + 1 : pending_rows;
+        if (breaks > 0) put_run(O, breaks, '$');
+        pending_rows = 0;
+
+        for (int j = 0; j < last;) {
+            int k = j;
+            while (k < last && row[k] == row[j]) k++;
+            put_run(O, k - j, row[j] ? 'o' : 'b');
+            j = k;
+        }
+    }
+    put_run(O, 1, '!');
+    put_str(O, "\n");
+}
+
+// Binary PBM (P4): every row is packed into bytes, most significant
+// bit first, with 1 meaning a live (black) cell.
+static void write_pbm(outbuf *O, grid *G) {
+    char header[64];
+    size_t bytes = (G->cols + 7) / 8;
+
+    snprintf(header, sizeof(header), "%d %d\n", G->cols, G->rows);
+    put_str(O, header);
+
+    for (int i = 0; i < G->rows; i++) {
+        const int *row = G->val[i];
+        unsigned char *dst = (unsigned char *)reserve(O, bytes);
+        size_t full = G->cols / 8;
+        int j = 0;
+
+        for (size_t b = 0; b < full; b++, j += 8) {
+            dst[b] = (unsigned char)((row[j] << 7) | (row[j + 1] << 6) | (row[j + 2] << 5) |
+                                     (row[j + 3] << 4) | (row[j + 4] << 3) | (row[j + 5] << 2) |
+                                     (row[j + 6] << 1) | row[j + 7]);
+        }
+        if (full < bytes) {
+            unsigned char last = 0;
+            for (int k = 0; j + k < G->cols; k++) {
+                last |= (unsigned char)(row[j + k] << (7 - k));
+            }
+            dst[full] = last;
+        }
+        O->len += bytes;
+    }
+}
+
+// Writes G to stream in the requested format. label is printed on
+// its own line in the text formats and stored as a comment in the
+// pattern formats.
+void write_grid(grid *G, FILE *stream, output_format format, const char *label) {
+    outbuf O = {stream, malloc(OUTBUF_SIZE), 0, OUTBUF_SIZE, 0};
+    char line[128];
+
+    switch (format) {
+        case OUTPUT_TEXT:
+            put_str(&O, label);
+            put_str(&O, "\n");
+            write_chars(&O, G, '0', '1');
+            put_str(&O, "\n");
+            break;
+        case OUTPUT_PLAINTEXT:
+            put_str(&O, "!");
+            put_str(&O, label);
+            put_str(&O, "\n");
+            write_chars(&O, G, '.', 'O');
+            break;
+        case OUTPUT_RLE:
+            put_str(&O, "#C ");
+            put_str(&O, label);
+            put_str(&O, "\n");
+            write_rle(&O, G);
+            break;
+        case OUTPUT_PBM:
+            put_str(&O, "P4\n# ");
+            put_str(&O, label);
+            put_str(&O, "\n");
+            write_pbm(&O, G);
+            break;
+        case OUTPUT_SUMMARY:
+            put_str(&O, label);
+            snprintf(line, sizeof(line), "\n%d x %d board, %ld live cells\n\n",
+                     G->rows, G->cols, count_population(G));
+            put_str(&O, line);
+            break;
+    }
+
+    flush_outbuf(&O);
+    fflush(stream);
+    free(O.buf);
+}
+
+// The per-generation statistics are written as a table in the same
+// ';'-separated layout as data.csv.
+void write_stats_header(FILE *stream) {
+    fprintf(stream, "Generation;Population;Births;Deaths;Min row;Min col;Max row;Max col\n");
+}
+
+// Appends the row of one generation; the bounding box of an empty
+// board is written as -1.
+void write_stats(FILE *stream, long generation, const gen_stats *stats) {
+    int empty = stats->population == 0;
+    fprintf(stream, "%ld;%ld;%ld;%ld;%d;%d;%d;%d\n", generation, stats->population,
+            stats->births, stats->deaths,
+            empty ? -1 : stats->min_row, empty ? -1 : stats->min_col,
+            empty ? -1 : stats->max_row, empty ? -1 : stats->max_col);
+}
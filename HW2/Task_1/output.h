@@ -0,0 +1,23 @@
+#include <stdio.h>
+#include "grid.h"
+#include "evolve.h"
+
+#ifndef _OUTPUT_H
+#define _OUTPUT_H
+
+// Board output formats.
+typedef enum {
+    OUTPUT_TEXT,            // '0'/'1' rows, the original print_grid format
+    OUTPUT_PLAINTEXT,       // '.'/'O' rows (.cells)
+    OUTPUT_RLE,             // run length encoded pattern
+    OUTPUT_PBM,             // binary bitmap, one bit per cell
+    OUTPUT_SUMMARY          // dimensions and population only
+} output_format;
+
+int parse_output_format(const char *name, output_format *format);
+long count_population(grid *G);
+void write_grid(grid *G, FILE *stream, output_format format, const char *label);
+void write_stats_header(FILE *stream);
+void write_stats(FILE *stream, long generation, const gen_stats *stats);
+
+#endif
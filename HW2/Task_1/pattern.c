@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "pattern.h"
+
+// RLE bodies smaller than this are decoded by a single thread,
+// splitting them is not worth the thread start-up.
+#define PARALLEL_RLE_MIN (1 << 20)
+
+// A slice of an RLE body. Slices always start right after a '$'
+// so that the first token of a slice is never a split run count.
+typedef struct {
+    grid *G;
+    const char *begin, *end;
+    int row, col;           // board position of the pattern origin
+    long start_row;         // pattern row the slice starts at
+    long rows;              // number of rows the slice advances
+    int clear_from, clear_to;
+} rle_slice;
+
+// Sets the cells [c0, c1) of pattern row r, clipped to the board.
+static void set_run(grid *G, long r, long c0, long c1) {
+    if (r < 0 || r >= G->rows) return;
+    if (c0 < 0) c0 = 0;
+    if (c1 > G->cols) c1 = G->cols;
+
+    int *dst = G->val[r];
+    for (long j = c0; j < c1; j++) {
+        dst[j] = 1;
+    }
+}
+
+// Returns a pointer to the start of the next line.
+static const char *next_line(const char *p, const char *end) {
+    const char *nl = memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Guesses the format from the first meaningful line.
+static pattern_format detect_format(const char *p, const char *end) {
+    if (end - p >= 10 && strncmp(p, "#Life 1.06", 10) == 0) {
+        return PATTERN_LIFE106;
+    }
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        if (p < end && *p != '#' && *p != '!' && !is_blank(*p)) {
+            const char *q = p + 1;
+            while (q < end && (*q == ' ' || *q == '\t')) q++;
+            if (*p == 'x' && q < end && *q == '=') return PATTERN_RLE;
+            return PATTERN_PLAINTEXT;
+        }
+        p = next_line(p, end);
+    }
+    return PATTERN_PLAINTEXT;
+}
+
+// Counts how many rows an RLE slice advances. This only has to
+// look at run counts in front of '$', so it is a lot cheaper than
+// actually decoding the slice.
+static long count_rle_rows(const char *p, const char *end) {
+    long rows = 0, n = 0;
+    for (; p < end; p++) {
+        char c = *p;
+        if (c >= '0' && c <= '9') {
+            n = n * 10 + (c - '0');
+        } else if (c == '$') {
+            rows += n ? n : 1;
+            n = 0;
+        } else if (!is_blank(c)) {
+            n = 0;
+        }
+    }
+    return rows;
+}
+
+// Decodes an RLE slice into the board, starting at pattern row
+// S->start_row and column 0. Dead runs only move the cursor since
+// the board has been cleared beforehand.
+static void decode_rle(rle_slice *S) {
+    long r = S->start_row, c = 0, n = 0;
+    for (const char *p = S->begin; p < S->end; p++) {
+        char ch = *p;
+        if (ch >= '0' && ch <= '9') {
+            n = n * 10 + (ch - '0');
+            continue;
+        }
+        if (is_blank(ch)) continue;
+
+        long run = n ? n : 1;
+        n = 0;
+        switch (ch) {
+            case '$':
+                r += run;
+                c = 0;
+                break;
+            case 'b':
+            case '.':
+                c += run;
+                break;
+            case '!':
+                return;
+            default:
+                // 'o' and the multi-state letters are all live cells
+                set_run(S->G, S->row + r, S->col + c, S->col + c + run);
+                c += run;
+                break;
+        }
+    }
+}
+
+static void clear_rows(grid *G, int from, int to) {
+    for (int i = from; i < to; i++) {
+        memset(G->val[i], 0, G->cols * sizeof(int));
+    }
+}
+
+// First pass of the parallel decoder: clear a share of the board
+// and measure how many rows our slice covers.
+static void *rle_scan_func(void *arguments) {
+    rle_slice *S = (rle_slice *)arguments;
+    clear_rows(S->G, S->clear_from, S->clear_to);
+    S->rows = count_rle_rows(S->begin, S->end);
+    return NULL;
+}
+
+static void *rle_decode_func(void *arguments) {
+    decode_rle((rle_slice *)arguments);
+    return NULL;
+}
+
+// Decodes an RLE body. Large bodies are cut into one slice per
+// thread at row boundaries; a quick scan tells every slice its
+// starting row, after which all slices are decoded in parallel.
+static void load_rle(grid *G, const char *p, const char *end, int row, int col, int threads) {
+    // Skip the comment lines and the "x = .., y = .., rule = .." header.
+    while (p < end) {
+        const char *line = p;
+        p = next_line(p, end);
+        while (line < p && is_blank(*line)) line++;
+        if (line == p || *line == '#') continue;
+
+        const char *rule = NULL;
+        for (const char *q = line; q + 4 < p; q++) {
+            if (strncasecmp(q, "rule", 4) == 0) {
+                rule = q + 4;
+                break;
+            }
+        }
+        if (rule) {
+            while (rule < p && (is_blank(*rule) || *rule == '=')) rule++;
+            int life = (p - rule >= 6 && strncasecmp(rule, "B3/S23", 6) == 0) ||
+                       (p - rule >= 4 && strncmp(rule, "23/3", 4) == 0);
+            if (!life) {
+                fprintf(stderr, "Warning: pattern rule is not B3/S23, decoding it as Life anyway.\n");
+            }
+        }
+        break;
+    }
+
+    const char *stop = memchr(p, '!', end - p);
+    if (stop) end = stop;
+
+    if (threads < 1 || end - p < PARALLEL_RLE_MIN) threads = 1;
+
+    rle_slice *slices = calloc(threads, sizeof(rle_slice));
+    pthread_t workers[threads];
+    const char *begin = p;
+    int share = G->rows / threads;
+
+    for (int i = 0; i < threads; i++) {
+        const char *cut = end;
+        if (i + 1 < threads) {
+            cut = begin + (end - begin) / threads * (i + 1);
+            if (cut < p) cut = p;
+            const char *dollar = memchr(cut, '$', end - cut);
+            cut = dollar ? dollar + 1 : end;
+        }
+        slices[i].G = G;
+        slices[i].begin = p;
+        slices[i].end = cut;
+        slices[i].row = row;
+        slices[i].col = col;
+        slices[i].clear_from = share * i;
+        slices[i].clear_to = (i + 1 < threads) ? share * (i + 1) : G->rows;
+        p = cut;
+    }
+
+    if (threads == 1) {
+        clear_rows(G, 0, G->rows);
+        decode_rle(&slices[0]);
+        free(slices);
+        return;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&workers[i], NULL, &rle_scan_func, (void *)&slices[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    for (int i = 1; i < threads; i++) {
+        slices[i].start_row = slices[i - 1].start_row + slices[i - 1].rows;
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&workers[i], NULL, &rle_decode_func, (void *)&slices[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(slices);
+}
+
+// Plaintext (.cells): every line that is not a '!' comment is a row.
+static void load_plaintext(grid *G, const char *p, const char *end, int row, int col) {
+    long r = 0;
+    clear_rows(G, 0, G->rows);
+
+    while (p < end) {
+        const char *line = p;
+        p = next_line(p, end);
+        if (*line == '!') continue;
+
+        for (const char *q = line; q < p; q++) {
+            if (*q == 'O' || *q == '*') {
+                set_run(G, row + r, col + (q - line), col + (q - line) + 1);
+            }
+        }
+        r++;
+    }
+}
+
+// Parses a decimal integer without running past end (the mapping
+// is not NUL-terminated, so strtol is off limits).
+static long parse_long(const char **cursor, const char *end) {
+    const char *p = *cursor;
+    long v = 0, sign = 1;
+
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p < end && (*p == '-' || *p == '+')) {
+        if (*p == '-') sign = -1;
+        p++;
+    }
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p++ - '0');
+    }
+    *cursor = p;
+    return sign * v;
+}
+
+// Reads the next "x y" pair of a Life 1.06 body. Returns 0 at the end.
+static int next_cell(const char **cursor, const char *end, long *x, long *y) {
+    const char *p = *cursor;
+    while (p < end) {
+        const char *line = p;
+        p = next_line(p, end);
+        while (line < p && is_blank(*line)) line++;
+        if (line == p || *line == '#') continue;
+
+        *x = parse_long(&line, p);
+        *y = parse_long(&line, p);
+        *cursor = p;
+        return 1;
+    }
+    *cursor = p;
+    return 0;
+}
+
+// Life 1.06: a list of live cell coordinates relative to some origin.
+// The coordinates are shifted so the top-left live cell lands on
+// the requested offset.
+static void load_life106(grid *G, const char *p, const char *end, int row, int col) {
+    long x, y, min_x = 0, min_y = 0;
+    int first = 1;
+    const char *cursor = p;
+
+    clear_rows(G, 0, G->rows);
+    while (next_cell(&cursor, end, &x, &y)) {
+        if (first || x < min_x) min_x = x;
+        if (first || y < min_y) min_y = y;
+        first = 0;
+    }
+
+    cursor = p;
+    while (next_cell(&cursor, end, &x, &y)) {
+        set_run(G, row + (y - min_y), col + (x - min_x), col + (x - min_x) + 1);
+    }
+}
+
+// Maps the pattern file at path and decodes it straight into G with
+// its top-left corner at (row, col). Cells falling outside the board
+// are dropped and the rest of the board is cleared. threads is the
+// number of threads allowed for decoding large RLE files.
+// Returns 0 on success and -1 if the file could not be mapped.
+int load_pattern(grid *G, const char *path, int row, int col, int threads) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        clear_rows(G, 0, G->rows);
+        return 0;
+    }
+
+    const char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+    madvise((void *)data, st.st_size, MADV_SEQUENTIAL);
+
+    const char *end = data + st.st_size;
+    switch (detect_format(data, end)) {
+        case PATTERN_RLE:
+            load_rle(G, data, end, row, col, threads);
+            break;
+        case PATTERN_LIFE106:
+            load_life106(G, data, end, row, col);
+            break;
+        default:
+            load_plaintext(G, data, end, row, col);
+            break;
+    }
+
+    munmap((void *)data, st.st_size);
+    return 0;
+}
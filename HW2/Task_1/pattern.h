@@ -0,0 +1,15 @@
+#include "grid.h"
+
+#ifndef _PATTERN_H
+#define _PATTERN_H
+
+// Pattern file formats understood by load_pattern.
+typedef enum {
+    PATTERN_PLAINTEXT,      // .cells: '.' and 'O' rows, '!' comments
+    PATTERN_RLE,            // run length encoded, "x = .., y = .." header
+    PATTERN_LIFE106         // "#Life 1.06" followed by x y pairs
+} pattern_format;
+
+int load_pattern(grid *G, const char *path, int row, int col, int threads);
+
+#endif
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "reader.h"
+
+// Character classes used by the board scanner.
+enum {
+    CH_DEAD,
+    CH_ALIVE,
+    CH_SPACE,
+    CH_NEWLINE,
+    CH_INVALID
+};
+
+static unsigned char char_class[256];
+
+// Fills the character class table once. Cells may be written
+// as '0'/'1' (the original whitespace-separated format) or as
+// '.'/'O' (the plaintext pattern format).
+static void init_char_class() {
+    static int ready = 0;
+    if (ready) return;
+
+    for (int i = 0; i < 256; i++) {
+        char_class[i] = CH_INVALID;
+    }
+    char_class['0'] = char_class['.'] = CH_DEAD;
+    char_class['1'] = char_class['O'] = char_class['o'] = char_class['*'] = CH_ALIVE;
+    char_class[' '] = char_class['\t'] = char_class['\r'] = CH_SPACE;
+    char_class['\v'] = char_class['\f'] = CH_SPACE;
+    char_class['\n'] = CH_NEWLINE;
+    ready = 1;
+}
+
+// Allocates a reader on top of stream with a buffer of block bytes.
+// The reader goes through fread, so anything stdio has already
+// buffered (e.g. the answers to the prompts) is not lost. On a
+// terminal a whole block would only arrive once the user ends the
+// input, so there the stream is read a line at a time instead.
+reader *init_reader(FILE *stream, size_t block) {
+    reader *R = (reader *)malloc(sizeof(reader));
+    R->stream = stream;
+    R->buf = malloc(block);
+    R->size = block;
+    R->len = 0;
+    R->pos = 0;
+    R->eof = 0;
+    R->interactive = isatty(fileno(stream));
+    init_char_class();
+    return R;
+}
+
+void destroy_reader(reader *R) {
+    free(R->buf);
+    free(R);
+}
+
+// Pulls the next block of the stream into the buffer.
+// Returns 0 once the stream is exhausted.
+static int refill(reader *R) {
+    if (R->eof) return 0;
+
+    if (R->interactive) {
+        R->len = fgets(R->buf, (int)R->size, R->stream) ? strlen(R->buf) : 0;
+    } else {
+        R->len = fread(R->buf, 1, R->size, R->stream);
+    }
+    R->pos = 0;
+    if (R->len == 0) {
+        R->eof = 1;
+        return 0;
+    }
+    return 1;
+}
+
+// Skips whitespace and newlines, leaving the reader at the first
+// meaningful character. Returns 0 if the stream ended first.
+static int skip_blank(reader *R) {
+    for (;;) {
+        while (R->pos < R->len) {
+            int c = char_class[(unsigned char)R->buf[R->pos]];
+            if (c != CH_SPACE && c != CH_NEWLINE) return 1;
+            R->pos++;
+        }
+        if (!refill(R)) return 0;
+    }
+}
+
+// Looks at the buffered part of the first line to decide which
+// format we are reading. Cells separated by blanks mean the original
+// token format where line breaks carry no meaning; otherwise every
+// line is one row of compact text.
+static int is_token_format(reader *R) {
+    int seen_cell = 0, seen_space = 0;
+    for (size_t p = R->pos; p < R->len; p++) {
+        int c = char_class[(unsigned char)R->buf[p]];
+        if (c == CH_NEWLINE) break;
+        if (c == CH_SPACE) {
+            seen_space = seen_cell;
+        } else if (seen_space) {
+            return 1;
+        } else {
+            seen_cell = 1;
+        }
+    }
+    return 0;
+}
+
+// Marks the cells of the given row from col onwards as dead.
+static void pad_row(grid *G, int row, int col) {
+    memset(G->val[row] + col, 0, (G->cols - col) * sizeof(int));
+}
+
+// Marks every cell from (row, col) to the end of the board as dead.
+// Used to finish a board whose input ended early or was malformed.
+static void clear_from(grid *G, int row, int col) {
+    if (row >= G->rows) return;
+    pad_row(G, row, col);
+    for (int i = row + 1; i < G->rows; i++) {
+        pad_row(G, i, 0);
+    }
+}
+
+// Reads a rows x cols board into G. Both the whitespace-separated
+// format accepted by the old scanf loop and compact one-line-per-row
+// text are understood; in the compact format short rows are padded
+// with dead cells. Returns the number of rows read, or -1 on a
+// malformed board (the rest of G is then left dead).
+int read_board(reader *R, grid *G) {
+    int token, i = 0, j = 0;
+
+    if (!skip_blank(R)) {
+        clear_from(G, 0, 0);
+        return 0;
+    }
+    token = is_token_format(R);
+
+    while (i < G->rows) {
+        if (R->pos == R->len && !refill(R)) break;
+
+        int *row = G->val[i];
+        const unsigned char *p = (const unsigned char *)R->buf + R->pos;
+        const unsigned char *end = (const unsigned char *)R->buf + R->len;
+
+        // Hot loop: consume the buffered bytes of the current row.
+        while (p < end) {
+            int c = char_class[*p++];
+            if (c <= CH_ALIVE) {
+                if (j == G->cols) {
+                    fprintf(stderr, "Row %d is longer than %d cells.\n", i + 1, G->cols);
+                    clear_from(G, i, j);
+                    return -1;
+                }
+                row[j++] = c;
+
+                // Line breaks carry no meaning in the token format,
+                // a row ends as soon as it is full.
+                if (token && j == G->cols) {
+                    j = 0;
+                    if (++i == G->rows) break;
+                    row = G->val[i];
+                }
+            } else if (c == CH_NEWLINE && !token) {
+                pad_row(G, i, j);
+                j = 0;
+                if (++i == G->rows) break;
+                row = G->val[i];
+            } else if (c == CH_INVALID) {
+                fprintf(stderr, "Unexpected character '%c' in row %d.\n", p[-1], i + 1);
+                clear_from(G, i, j);
+                return -1;
+            }
+        }
+        R->pos = p - (const unsigned char *)R->buf;
+    }
+
+    int read = (i < G->rows && j > 0) ? i + 1 : i;
+    clear_from(G, i, j);
+    return read;
+}
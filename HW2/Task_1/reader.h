@@ -0,0 +1,24 @@
+#include <stdio.h>
+#include "grid.h"
+
+#ifndef _READER_H
+#define _READER_H
+
+// reader is a block-buffered input stream. Instead of asking
+// stdio for every single value, it pulls large blocks out of
+// the stream and lets a hand-written scanner walk the buffer.
+typedef struct {
+    FILE *stream;
+    char *buf;
+    size_t size;        // capacity of buf
+    size_t len;         // number of valid bytes in buf
+    size_t pos;         // scanner position inside buf
+    int eof;            // stream is exhausted
+    int interactive;    // stream is a terminal, read it a line at a time
+} reader;
+
+reader *init_reader(FILE *stream, size_t block);
+void destroy_reader(reader *R);
+int read_board(reader *R, grid *G);
+
+#endif
@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sat.h"
+
+// Band entry (i, c) as a 64-bit number.
+static inline uint64_t entry(const sat *S, int i, int c) {
+    size_t k = (size_t)i * (S->cols + 1) + c;
+    return S->wide ? ((const uint64_t *)S->sums)[k] : ((const uint32_t *)S->sums)[k];
+}
+
+// Live cells in rows [0, r) and columns [0, c).
+static inline uint64_t corner(const sat *S, int r, int c) {
+    if (r == 0) {
+        return 0;
+    }
+    return entry(S, r - 1, c) + S->carry[(size_t)((r - 1) / S->height) * (S->cols + 1) + c];
+}
+
+// Allocates the table of a rows x cols board cut into bands equal row
+// sections (bands must divide rows, like the number of threads).
+sat *init_sat(int rows, int cols, int bands) {
+    sat *S = (sat *)malloc(sizeof(sat));
+    S->rows = rows;
+    S->cols = cols;
+    S->bands = bands;
+    S->height = rows / bands;
+    S->wide = (uint64_t)S->height * cols > UINT32_MAX;
+    S->sums = calloc((size_t)rows * (cols + 1), S->wide ? sizeof(uint64_t) : sizeof(uint32_t));
+    S->carry = calloc((size_t)bands * (cols + 1), sizeof(uint64_t));
+    return S;
+}
+
+void destroy_sat(sat *S) {
+    free(S->sums);
+    free(S->carry);
+    free(S);
+}
+
+// Fills the entries of one band from G. Bands are independent, so
+// every thread can fill its own.
+void sat_band(sat *S, grid *G, int band) {
+    int from = band * S->height, to = from + S->height;
+    size_t stride = S->cols + 1;
+
+    for (int i = from; i < to; i++) {
+        const int *row = G->val[i];
+        uint64_t run = 0;
+
+        if (S->wide) {
+            uint64_t *out = (uint64_t *)S->sums + (size_t)i * stride;
+            const uint64_t *up = i > from ? out - stride : NULL;
+            out[0] = 0;
+            for (int c = 0; c < S->cols; c++) {
+                run += row[c] & 1;
+                out[c + 1] = run + (up ? up[c + 1] : 0);
+            }
+        } else {
+            uint32_t *out = (uint32_t *)S->sums + (size_t)i * stride;
+            const uint32_t *up = i > from ? out - stride : NULL;
+            out[0] = 0;
+            for (int c = 0; c < S->cols; c++) {
+                run += row[c] & 1;
+                out[c + 1] = (uint32_t)run + (up ? up[c + 1] : 0);
+            }
+        }
+    }
+}
+
+// Adds up the last rows of the bands into the carries. One thread
+// calls it once every band is filled; it touches bands x cols entries.
+void sat_finish(sat *S) {
+    size_t stride = S->cols + 1;
+
+    memset(S->carry, 0, stride * sizeof(uint64_t));
+    for (int b = 1; b < S->bands; b++) {
+        int last = b * S->height - 1;
+        for (int c = 0; c <= S->cols; c++) {
+            S->carry[b * stride + c] = S->carry[(b - 1) * stride + c] + entry(S, last, c);
+        }
+    }
+}
+
+// Builds the whole table from G in the calling thread.
+void build_sat(sat *S, grid *G) {
+    for (int b = 0; b < S->bands; b++) {
+        sat_band(S, G, b);
+    }
+    sat_finish(S);
+}
+
+// Live cells in rect, from four corners of the table.
+uint64_t sat_sum(const sat *S, tile rect) {
+    return corner(S, rect.r1, rect.c1) - corner(S, rect.r0, rect.c1)
+         - corner(S, rect.r1, rect.c0) + corner(S, rect.r0, rect.c0);
+}
+
+// Reads the rectangles to count from path, one 'R,C,HxW' (like
+// --window) per line, clipped to the board, and opens out for the
+// counts. Returns NULL on error.
+region_set *load_regions(const char *path, const char *out, int rows, int cols, int bands) {
+    FILE *in = fopen(path, "r");
+    char line[256];
+    int r, c, h, w, cap = 16;
+
+    if (in == NULL) {
+        perror(path);
+        return NULL;
+    }
+    region_set *R = calloc(1, sizeof(region_set));
+    R->rects = malloc(cap * sizeof(tile));
+    while (fgets(line, sizeof(line), in)) {
+        if (sscanf(line, "%d,%d,%dx%d", &r, &c, &h, &w) != 4) {
+            continue;
+        }
+        if (r < 0 || c < 0 || h <= 0 || w <= 0 || r >= rows || c >= cols) {
+            fprintf(stderr, "Skipping region %d,%d,%dx%d, which is not on the %d x %d board.\n",
+                    r, c, h, w, rows, cols);
+            continue;
+        }
+        if (R->count == cap) {
+            cap *= 2;
+            R->rects = realloc(R->rects, cap * sizeof(tile));
+        }
+        tile *t = &R->rects[R->count++];
+        t->r0 = r;
+        t->c0 = c;
+        t->r1 = r + h < rows ? r + h : rows;
+        t->c1 = c + w < cols ? c + w : cols;
+    }
+    fclose(in);
+
+    R->out = fopen(out, "w");
+    if (R->out == NULL) {
+        perror(out);
+        free(R->rects);
+        free(R);
+        return NULL;
+    }
+    fprintf(R->out, "Generation");
+    for (int i = 0; i < R->count; i++) {
+        const tile *t = &R->rects[i];
+        fprintf(R->out, ";%d,%d,%dx%d", t->r0, t->c0, t->r1 - t->r0, t->c1 - t->c0);
+    }
+    fprintf(R->out, "\n");
+    R->table = init_sat(rows, cols, bands);
+    return R;
+}
+
+// Appends the population of every region, counted from the finished
+// table, as the row of generation.
+void write_region_counts(region_set *R, long generation) {
+    fprintf(R->out, "%ld", generation);
+    for (int i = 0; i < R->count; i++) {
+        fprintf(R->out, ";%lu", (unsigned long)sat_sum(R->table, R->rects[i]));
+    }
+    fprintf(R->out, "\n");
+}
+
+void destroy_regions(region_set *R) {
+    fclose(R->out);
+    destroy_sat(R->table);
+    free(R->rects);
+    free(R);
+}
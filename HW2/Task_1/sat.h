@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "grid.h"
+#include "tiling.h"
+
+#ifndef _SAT_H
+#define _SAT_H
+
+// sat is a summed-area table of a board, built band by band so that
+// every thread can fill its own row section at once. Entry (i, c) of
+// a band holds the live cells in columns [0, c) of the band's rows up
+// to and including i; carry[b] holds the same for all rows above band
+// b. Band entries are 32-bit unless a band has more cells than that,
+// the carries (one row per band) are always 64-bit.
+typedef struct {
+    int rows, cols;
+    int bands, height;          // height rows per band
+    int wide;                   // entries are uint64_t instead of uint32_t
+    void *sums;                 // rows x (cols + 1) band entries
+    uint64_t *carry;            // bands x (cols + 1)
+} sat;
+
+// The rectangles whose populations are written for every generation,
+// with the table they are counted from.
+typedef struct {
+    int count;
+    tile *rects;
+    sat *table;
+    FILE *out;
+} region_set;
+
+sat *init_sat(int rows, int cols, int bands);
+void destroy_sat(sat *S);
+void sat_band(sat *S, grid *G, int band);
+void sat_finish(sat *S);
+void build_sat(sat *S, grid *G);
+uint64_t sat_sum(const sat *S, tile rect);
+
+region_set *load_regions(const char *path, const char *out, int rows, int cols, int bands);
+void write_region_counts(region_set *R, long generation);
+void destroy_regions(region_set *R);
+
+#endif
@@ -0,0 +1,513 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "soup.h"
+#include "bitlife.h"
+#include "grid.h"
+
+// Soups handed to a worker at a time.
+#define SOUP_CHUNK 64
+
+// Boards kept to look for repeats: the current one and SOUP_MAX_PERIOD
+// before it.
+#define SOUP_RING (SOUP_MAX_PERIOD + 1)
+
+// Long enough for the Wechsler string of any object that fits on the
+// board, and for that string behind its 'xs<cells>_' or 'xp<period>_'.
+#define SOUP_CODE_MAX 2048
+#define SOUP_NAME_MAX (SOUP_CODE_MAX + 16)
+
+typedef uint64_t board[SOUP_SIZE];
+
+typedef struct {
+    long soups;
+    unsigned int first_seed;
+    atomic_long next;
+} soup_job;
+
+// A cell of an object, relative to nothing in particular.
+typedef struct {
+    int r, c;
+} cell;
+
+// Working space of the census, one per worker.
+typedef struct {
+    int label[SOUP_SIZE][SOUP_SIZE];            // component + 1, 0 for dead cells
+    int parent[SOUP_SIZE * SOUP_SIZE];          // union-find over components
+    int start[SOUP_SIZE * SOUP_SIZE + 1];       // first member of every object
+    cell members[SOUP_SIZE * SOUP_SIZE];
+    cell cells[SOUP_SIZE * SOUP_SIZE];
+    cell moved[SOUP_SIZE * SOUP_SIZE];
+    uint8_t bits[SOUP_SIZE][SOUP_SIZE];
+} soup_scratch;
+
+typedef struct {
+    soup_job *job;
+    soup_summary summary;
+} soup_worker;
+
+static void step(const uint64_t *in, uint64_t *out) {
+    for (int i = 0; i < SOUP_SIZE; i++) {
+        uint64_t u = i > 0 ? in[i - 1] : 0;
+        uint64_t m = in[i];
+        uint64_t d = i + 1 < SOUP_SIZE ? in[i + 1] : 0;
+        out[i] = life_word(u << 1, u, u >> 1, m << 1, m, m >> 1, d << 1, d, d >> 1);
+    }
+}
+
+static uint64_t hash_board(const uint64_t *B) {
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < SOUP_SIZE; i++) {
+        h = (h ^ B[i]) * 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static int alive(const uint64_t *B, int r, int c) {
+    return (int)((B[r] >> c) & 1);
+}
+
+static uint64_t hash_code(const char *code) {
+    uint64_t h = 14695981039346656037ULL;
+    for (; *code; code++) {
+        h = (h ^ (unsigned char)*code) * 1099511628211ULL;
+    }
+    return h;
+}
+
+// Adds count to the entry of code, creating it if needed.
+static void census_add(census *C, const char *code, long count) {
+    if (2 * (C->count + 1) > C->cap) {
+        census old = *C;
+        C->cap = old.cap ? 2 * old.cap : 256;
+        C->entries = calloc(C->cap, sizeof(census_entry));
+        C->count = 0;
+        for (size_t i = 0; i < old.cap; i++) {
+            if (old.entries[i].code) {
+                size_t k = hash_code(old.entries[i].code) & (C->cap - 1);
+                while (C->entries[k].code) k = (k + 1) & (C->cap - 1);
+                C->entries[k] = old.entries[i];
+                C->count++;
+            }
+        }
+        free(old.entries);
+    }
+    size_t k = hash_code(code) & (C->cap - 1);
+    while (C->entries[k].code && strcmp(C->entries[k].code, code) != 0) {
+        k = (k + 1) & (C->cap - 1);
+    }
+    if (C->entries[k].code == NULL) {
+        C->entries[k].code = strdup(code);
+        C->count++;
+    }
+    C->entries[k].count += count;
+}
+
+// Appends the zeros of a run to code in extended Wechsler notation:
+// 'w' for two, 'x' for three and 'y' plus a digit for 4 to 39.
+static size_t put_zeros(char *code, size_t n, int zeros) {
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    while (zeros > 0) {
+        if (zeros >= 4) {
+            int run = zeros < 39 ? zeros : 39;
+            code[n++] = 'y';
+            code[n++] = digits[run - 4];
+            zeros -= run;
+        } else if (zeros == 3) {
+            code[n++] = 'x';
+            zeros = 0;
+        } else if (zeros == 2) {
+            code[n++] = 'w';
+            zeros = 0;
+        } else {
+            code[n++] = '0';
+            zeros = 0;
+        }
+    }
+    return n;
+}
+
+// Writes the Wechsler string of cells, in orientation t (bit 0 flips
+// the rows, bit 1 the columns, bit 2 swaps them), into code.
+static void wechsler(soup_scratch *S, const cell *cells, int count, int t, char *code) {
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuv";
+    uint8_t (*bits)[SOUP_SIZE] = S->bits;
+    cell *moved = S->moved;
+    int min_r = SOUP_SIZE, min_c = SOUP_SIZE, max_r = -SOUP_SIZE, max_c = -SOUP_SIZE;
+    size_t n = 0;
+
+    for (int k = 0; k < count; k++) {
+        int r = cells[k].r, c = cells[k].c;
+        if (t & 1) r = -r;
+        if (t & 2) c = -c;
+        if (t & 4) {
+            int swap = r;
+            r = c;
+            c = swap;
+        }
+        moved[k].r = r;
+        moved[k].c = c;
+        if (r < min_r) min_r = r;
+        if (c < min_c) min_c = c;
+        if (r > max_r) max_r = r;
+        if (c > max_c) max_c = c;
+    }
+    int height = max_r - min_r + 1, width = max_c - min_c + 1;
+    for (int r = 0; r < height; r++) {
+        memset(bits[r], 0, width);
+    }
+    for (int k = 0; k < count; k++) {
+        bits[moved[k].r - min_r][moved[k].c - min_c] = 1;
+    }
+
+    // Strips of five rows, one digit per column, separated by 'z';
+    // the zeros at the end of a strip are left out.
+    for (int strip = 0; strip < height; strip += 5) {
+        int zeros = 0;
+        if (strip > 0) code[n++] = 'z';
+        for (int c = 0; c < width; c++) {
+            int v = 0;
+            for (int k = 0; k < 5 && strip + k < height; k++) {
+                v |= bits[strip + k][c] << k;
+            }
+            if (v == 0) {
+                zeros++;
+                continue;
+            }
+            n = put_zeros(code, n, zeros);
+            zeros = 0;
+            code[n++] = digits[v];
+        }
+    }
+    code[n] = '\0';
+}
+
+// Puts the canonical code of an object into code: the best Wechsler
+// string over its phases (the first period boards of phases) and the
+// eight orientations. members lists the object's cells over all
+// phases. code has room for SOUP_NAME_MAX characters.
+static void canonical_code(soup_scratch *S, board *phases, int period, const cell *members, int count,
+                           char *code) {
+    cell *cells = S->cells;
+    char candidate[SOUP_CODE_MAX];
+    char best[SOUP_CODE_MAX];
+    size_t best_len = 0;
+    int population = 0;
+
+    for (int q = 0; q < period; q++) {
+        int n = 0;
+        for (int k = 0; k < count; k++) {
+            if (alive(phases[q], members[k].r, members[k].c)) cells[n++] = members[k];
+        }
+        if (q == 0) population = n;
+        for (int t = 0; t < 8; t++) {
+            wechsler(S, cells, n, t, candidate);
+            size_t len = strlen(candidate);
+            if (best_len == 0 || len < best_len || (len == best_len && strcmp(candidate, best) < 0)) {
+                memcpy(best, candidate, len + 1);
+                best_len = len;
+            }
+        }
+    }
+    if (period == 1) {
+        snprintf(code, SOUP_NAME_MAX, "xs%d_%s", population, best);
+    } else {
+        snprintf(code, SOUP_NAME_MAX, "xp%d_%s", period, best);
+    }
+}
+
+static int find_root(int *parent, int k) {
+    while (parent[k] != k) {
+        parent[k] = parent[parent[k]];
+        k = parent[k];
+    }
+    return k;
+}
+
+// Labels the 8-connected components of B from 1 up and returns their
+// number, using members as the flood fill stack.
+static int label_components(soup_scratch *S, const uint64_t *B) {
+    int (*label)[SOUP_SIZE] = S->label;
+    cell *stack = S->members;
+    int components = 0;
+
+    memset(label, 0, sizeof(S->label));
+    for (int i = 0; i < SOUP_SIZE; i++) {
+        for (int j = 0; j < SOUP_SIZE; j++) {
+            if (!alive(B, i, j) || label[i][j]) continue;
+
+            int top = 0;
+            label[i][j] = ++components;
+            stack[top++] = (cell){i, j};
+            while (top > 0) {
+                cell m = stack[--top];
+                for (int r = m.r - 1; r <= m.r + 1; r++) {
+                    for (int c = m.c - 1; c <= m.c + 1; c++) {
+                        if (r < 0 || c < 0 || r >= SOUP_SIZE || c >= SOUP_SIZE) continue;
+                        if (!alive(B, r, c) || label[r][c]) continue;
+                        label[r][c] = components;
+                        stack[top++] = (cell){r, c};
+                    }
+                }
+            }
+        }
+    }
+    return components;
+}
+
+// Merges the components that interact in the step from phase now to
+// phase next: wherever cells of several components are neighbours,
+// each component is evolved on its own, and if the cell then comes out
+// differently than on the board, all of them belong to one object.
+static void merge_interacting(soup_scratch *S, const uint64_t *now, const uint64_t *next) {
+    int (*label)[SOUP_SIZE] = S->label;
+
+    for (int i = 0; i < SOUP_SIZE; i++) {
+        for (int j = 0; j < SOUP_SIZE; j++) {
+            int seen[9], neighbours[9], self[9], kinds = 0;
+
+            for (int r = i - 1; r <= i + 1; r++) {
+                for (int c = j - 1; c <= j + 1; c++) {
+                    if (r < 0 || c < 0 || r >= SOUP_SIZE || c >= SOUP_SIZE || !alive(now, r, c)) continue;
+                    int k = 0;
+                    while (k < kinds && seen[k] != label[r][c]) k++;
+                    if (k == kinds) {
+                        seen[kinds] = label[r][c];
+                        neighbours[kinds] = 0;
+                        self[kinds++] = 0;
+                    }
+                    if (r == i && c == j) {
+                        self[k] = 1;
+                    } else {
+                        neighbours[k]++;
+                    }
+                }
+            }
+            if (kinds < 2) continue;
+
+            int apart = 0;
+            for (int k = 0; k < kinds; k++) {
+                apart |= neighbours[k] == 3 || (self[k] && neighbours[k] == 2);
+            }
+            if (apart == alive(next, i, j)) continue;
+            for (int k = 1; k < kinds; k++) {
+                S->parent[find_root(S->parent, seen[k] - 1)] = find_root(S->parent, seen[0] - 1);
+            }
+        }
+    }
+}
+
+// Splits the stable board, whose period phases are in phases, into
+// objects and counts them. Cells that are ever alive are first split
+// into 8-connected components; components are then joined only where
+// their evolution interacts in some phase, as apgsearch does, so a
+// pulsar or a beacon is one object while a block next to a blinker is
+// two. Objects that come within a cell of the border may be debris of
+// gliders hitting it, so they are only counted as edge objects.
+static void take_census(soup_scratch *S, board *phases, int period, soup_summary *summary) {
+    int (*label)[SOUP_SIZE] = S->label;
+    int *parent = S->parent, *start = S->start;
+    cell *members = S->members;
+    char code[SOUP_NAME_MAX];
+    board any;
+
+    memset(any, 0, sizeof(any));
+    for (int q = 0; q < period; q++) {
+        for (int i = 0; i < SOUP_SIZE; i++) {
+            any[i] |= phases[q][i];
+        }
+    }
+    int components = label_components(S, any);
+    for (int k = 0; k < components; k++) {
+        parent[k] = k;
+    }
+    for (int q = 0; q < period; q++) {
+        merge_interacting(S, phases[q], phases[(q + 1) % period]);
+    }
+
+    // Counting sort of the cells by object; the objects are numbered
+    // by their roots.
+    memset(start, 0, (components + 1) * sizeof(int));
+    for (int i = 0; i < SOUP_SIZE; i++) {
+        for (int j = 0; j < SOUP_SIZE; j++) {
+            if (label[i][j]) start[find_root(parent, label[i][j] - 1) + 1]++;
+        }
+    }
+    for (int k = 0; k < components; k++) {
+        start[k + 1] += start[k];
+    }
+    for (int i = 0; i < SOUP_SIZE; i++) {
+        for (int j = 0; j < SOUP_SIZE; j++) {
+            if (label[i][j]) members[start[find_root(parent, label[i][j] - 1)]++] = (cell){i, j};
+        }
+    }
+    // start[k] is now the end of object k, and the start of k + 1.
+
+    for (int k = 0, from = 0; k < components; from = start[k++]) {
+        int count = start[k] - from, edge = 0;
+        const cell *object = members + from;
+        if (count == 0) continue;
+        for (int m = 0; m < count && !edge; m++) {
+            edge = object[m].r <= 1 || object[m].c <= 1 ||
+                   object[m].r >= SOUP_SIZE - 2 || object[m].c >= SOUP_SIZE - 2;
+        }
+        if (edge) {
+            summary->edge_objects++;
+            continue;
+        }
+
+        // The object's own period divides the board's.
+        int own = period;
+        for (int p = 1; p < period; p++) {
+            if (period % p) continue;
+            int same = 1;
+            for (int m = 0; m < count && same; m++) {
+                same = alive(phases[0], object[m].r, object[m].c) ==
+                       alive(phases[p], object[m].r, object[m].c);
+            }
+            if (same) {
+                own = p;
+                break;
+            }
+        }
+        canonical_code(S, phases, own, object, count, code);
+        census_add(&summary->objects, code, 1);
+    }
+}
+
+// Seeds soup seed into B through random_populate_r.
+static void seed_soup(grid *G, unsigned int seed, uint64_t *B) {
+    int offset = (SOUP_SIZE - SOUP_SEED) / 2;
+
+    random_populate_r(G, &seed);
+    memset(B, 0, sizeof(board));
+    for (int i = 0; i < SOUP_SEED; i++) {
+        for (int j = 0; j < SOUP_SEED; j++) {
+            B[offset + i] |= (uint64_t)(G->val[i][j] & 1) << (offset + j);
+        }
+    }
+}
+
+// Runs one soup to stability and takes its census.
+static void run_soup(soup_scratch *S, grid *G, unsigned int seed, board *ring, soup_summary *summary) {
+    uint64_t hashes[SOUP_RING];
+
+    seed_soup(G, seed, ring[0]);
+    hashes[0] = hash_board(ring[0]);
+    for (long g = 1; g <= SOUP_MAX_GENERATIONS; g++) {
+        uint64_t *now = ring[g % SOUP_RING];
+        step(ring[(g - 1) % SOUP_RING], now);
+        hashes[g % SOUP_RING] = hash_board(now);
+
+        for (int p = 1; p <= SOUP_MAX_PERIOD && p <= g; p++) {
+            int before = (int)((g - p) % SOUP_RING);
+            if (hashes[before] != hashes[g % SOUP_RING] || memcmp(ring[before], now, sizeof(board)) != 0) {
+                continue;
+            }
+            // Generations g - p to g - 1 are the p phases.
+            board phases[SOUP_MAX_PERIOD];
+            for (int q = 0; q < p; q++) {
+                memcpy(phases[q], ring[(g - p + q) % SOUP_RING], sizeof(board));
+            }
+            summary->generations += g;
+            take_census(S, phases, p, summary);
+            return;
+        }
+    }
+    summary->generations += SOUP_MAX_GENERATIONS;
+    summary->unstable++;
+}
+
+static void *soup_thread(void *arguments) {
+    soup_worker *worker = (soup_worker *)arguments;
+    soup_job *job = worker->job;
+    grid *G = init_grid(SOUP_SEED, SOUP_SEED);
+    board *ring = malloc(SOUP_RING * sizeof(board));
+    soup_scratch *S = malloc(sizeof(soup_scratch));
+
+    for (long first = atomic_fetch_add(&job->next, SOUP_CHUNK); first < job->soups;
+         first = atomic_fetch_add(&job->next, SOUP_CHUNK)) {
+        long end = first + SOUP_CHUNK < job->soups ? first + SOUP_CHUNK : job->soups;
+        for (long s = first; s < end; s++) {
+            run_soup(S, G, job->first_seed + (unsigned int)s, ring, &worker->summary);
+            worker->summary.soups++;
+        }
+    }
+    free(S);
+    free(ring);
+    destroy_grid(G);
+    return NULL;
+}
+
+// Runs soups random soups, soup k seeded with first_seed + k, and
+// fills summary with the merged census. Every worker keeps its own
+// census, so the workers share nothing but the soup counter.
+void search_soups(long soups, unsigned int first_seed, int workers, soup_summary *summary) {
+    if (workers < 1) workers = 1;
+    soup_job job;
+    soup_worker *w = calloc(workers, sizeof(soup_worker));
+    pthread_t threads[workers];
+
+    job.soups = soups;
+    job.first_seed = first_seed;
+    atomic_init(&job.next, 0);
+    for (int t = 0; t < workers; t++) {
+        w[t].job = &job;
+    }
+    for (int t = 1; t < workers; t++) {
+        pthread_create(&threads[t], NULL, &soup_thread, &w[t]);
+    }
+    soup_thread(&w[0]);
+    for (int t = 1; t < workers; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    *summary = w[0].summary;
+    for (int t = 1; t < workers; t++) {
+        summary->soups += w[t].summary.soups;
+        summary->unstable += w[t].summary.unstable;
+        summary->edge_objects += w[t].summary.edge_objects;
+        summary->generations += w[t].summary.generations;
+        census *C = &w[t].summary.objects;
+        for (size_t i = 0; i < C->cap; i++) {
+            if (C->entries[i].code) census_add(&summary->objects, C->entries[i].code, C->entries[i].count);
+        }
+        destroy_census(C);
+    }
+    free(w);
+}
+
+static int by_count(const void *a, const void *b) {
+    const census_entry *x = (const census_entry *)a, *y = (const census_entry *)b;
+    if (x->count != y->count) return x->count < y->count ? 1 : -1;
+    return strcmp(x->code, y->code);
+}
+
+// Writes the census, the most common objects first.
+void write_census(FILE *stream, const census *C) {
+    census_entry *sorted = malloc((C->count ? C->count : 1) * sizeof(census_entry));
+    size_t n = 0;
+
+    for (size_t i = 0; i < C->cap; i++) {
+        if (C->entries[i].code) sorted[n++] = C->entries[i];
+    }
+    qsort(sorted, n, sizeof(census_entry), by_count);
+    fprintf(stream, "Object;Count\n");
+    for (size_t i = 0; i < n; i++) {
+        fprintf(stream, "%s;%ld\n", sorted[i].code, sorted[i].count);
+    }
+    free(sorted);
+}
+
+void destroy_census(census *C) {
+    for (size_t i = 0; i < C->cap; i++) {
+        free(C->entries[i].code);
+    }
+    free(C->entries);
+    C->entries = NULL;
+    C->cap = 0;
+    C->count = 0;
+}
@@ -0,0 +1,47 @@
+#include <stdio.h>
+
+#ifndef _SOUP_H
+#define _SOUP_H
+
+// A soup is a SOUP_SEED x SOUP_SEED random square in the middle of an
+// empty SOUP_SIZE x SOUP_SIZE board with dead cells around it, one
+// 64-bit word per row.
+#define SOUP_SIZE 64
+#define SOUP_SEED 16
+
+// A soup is stable once its board repeats with a period up to
+// SOUP_MAX_PERIOD; soups that are not stable after
+// SOUP_MAX_GENERATIONS are given up on.
+#define SOUP_MAX_PERIOD 16
+#define SOUP_MAX_GENERATIONS 10000
+
+// One kind of object and how often it turned up.
+typedef struct {
+    char *code;
+    long count;
+} census_entry;
+
+// census counts objects by their canonical code: 'xs<cells>_' for
+// still lifes and 'xp<period>_' for oscillators, followed by the
+// cells in extended Wechsler notation, taken in the phase and
+// orientation that give the shortest (then smallest) string, as
+// apgsearch does.
+typedef struct {
+    census_entry *entries;      // open addressing, NULL code for free slots
+    size_t cap, count;
+} census;
+
+// The totals of a search.
+typedef struct {
+    long soups;
+    long unstable;              // not stable after SOUP_MAX_GENERATIONS
+    long edge_objects;          // left out of the census, see search_soups
+    long generations;           // evolved over all soups
+    census objects;
+} soup_summary;
+
+void search_soups(long soups, unsigned int first_seed, int workers, soup_summary *summary);
+void write_census(FILE *stream, const census *C);
+void destroy_census(census *C);
+
+#endif
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stream.h"
+
+#define LITERAL_FLAG 0x80000000u
+
+static long elapsed_ns(struct timespec *from, struct timespec *to) {
+    return 1000000000L * (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec);
+}
+
+// Compresses n words into out, which must have room for
+// n + n / 2 + 2 words in the worst case. Runs of zero words
+// (empty areas of the board) shrink to one control word, anything
+// else is copied as a literal block. Returns the size in bytes.
+static size_t compress_frame(const uint64_t *words, size_t n, unsigned char *out) {
+    unsigned char *p = out;
+    size_t i = 0;
+
+    while (i < n) {
+        size_t j = i;
+        uint32_t control;
+
+        if (words[i] == 0) {
+            while (j < n && words[j] == 0 && j - i < LITERAL_FLAG - 1) j++;
+            control = (uint32_t)(j - i);
+            memcpy(p, &control, 4);
+            p += 4;
+        } else {
+            // A literal block ends at the first pair of zero words,
+            // a single zero word is cheaper to keep inline.
+            while (j < n && j - i < LITERAL_FLAG - 1 &&
+                   (words[j] != 0 || (j + 1 < n && words[j + 1] != 0))) j++;
+            control = LITERAL_FLAG | (uint32_t)(j - i);
+            memcpy(p, &control, 4);
+            memcpy(p + 4, words + i, (j - i) * sizeof(uint64_t));
+            p += 4 + (j - i) * sizeof(uint64_t);
+        }
+        i = j;
+    }
+    return p - out;
+}
+
+// The writer thread: takes queued frames in order, compresses them
+// outside the lock and returns the buffers to the pool.
+static void *writer_func(void *arguments) {
+    stream *S = (stream *)arguments;
+    bitgrid *B = S->frames[0];
+    size_t words = (size_t)B->rows * B->words;
+    unsigned char *packed = malloc((words + words / 2 + 2) * sizeof(uint64_t));
+
+    pthread_mutex_lock(&S->mutex);
+    for (;;) {
+        while (S->queued == 0 && !S->stop) {
+            pthread_cond_wait(&S->cv, &S->mutex);
+        }
+        if (S->queued == 0) break;
+
+        int f = S->queue[S->head];
+        long generation = S->generation[f];
+        pthread_mutex_unlock(&S->mutex);
+
+        frame_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, FRAME_MAGIC, sizeof(header.magic));
+        header.rows = B->rows;
+        header.cols = B->cols;
+        header.generation = generation;
+        header.raw_size = words * sizeof(uint64_t);
+        header.payload_size = compress_frame(S->frames[f]->bits, words, packed);
+        fwrite(&header, sizeof(header), 1, S->out);
+        fwrite(packed, 1, header.payload_size, S->out);
+
+        pthread_mutex_lock(&S->mutex);
+        S->head = (S->head + 1) % S->size;
+        S->queued--;
+        S->free_frames[S->free_count++] = f;
+        S->written++;
+        S->raw_bytes += header.raw_size;
+        S->compressed_bytes += header.payload_size + sizeof(header);
+        pthread_cond_broadcast(&S->cv);
+    }
+    pthread_mutex_unlock(&S->mutex);
+
+    fflush(S->out);
+    free(packed);
+    return NULL;
+}
+
+// Starts streaming a rows x cols board to out every interval
+// generations through a pool of the given number of frames.
+stream *init_stream(FILE *out, int interval, int frames, stream_policy policy, int rows, int cols) {
+    stream *S = (stream *)calloc(1, sizeof(stream));
+    S->out = out;
+    S->interval = interval;
+    S->policy = policy;
+    S->size = frames;
+    S->frames = malloc(frames * sizeof(bitgrid *));
+    S->generation = calloc(frames, sizeof(long));
+    S->free_frames = malloc(frames * sizeof(int));
+    S->queue = malloc(frames * sizeof(int));
+    for (int i = 0; i < frames; i++) {
+        S->frames[i] = init_bitgrid(rows, cols);
+        S->free_frames[i] = frames - 1 - i;
+    }
+    S->free_count = frames;
+    S->current = -1;
+    pthread_mutex_init(&S->mutex, NULL);
+    pthread_cond_init(&S->cv, NULL);
+    pthread_create(&S->thread, NULL, &writer_func, (void *)S);
+    return S;
+}
+
+// Writes out everything still queued and stops the writer thread.
+void finish_stream(stream *S) {
+    if (S->stop) return;
+
+    pthread_mutex_lock(&S->mutex);
+    S->stop = 1;
+    pthread_cond_broadcast(&S->cv);
+    pthread_mutex_unlock(&S->mutex);
+    pthread_join(S->thread, NULL);
+}
+
+void destroy_stream(stream *S) {
+    finish_stream(S);
+    pthread_mutex_destroy(&S->mutex);
+    pthread_cond_destroy(&S->cv);
+    for (int i = 0; i < S->size; i++) {
+        destroy_bitgrid(S->frames[i]);
+    }
+    free(S->frames);
+    free(S->generation);
+    free(S->free_frames);
+    free(S->queue);
+    free(S);
+}
+
+int stream_due(stream *S, long generation) {
+    return S->interval > 0 && generation % S->interval == 0;
+}
+
+// Called by one thread to grab a free frame for the next snapshot.
+// If the pool is exhausted this either waits for the writer or, with
+// STREAM_DROP, gives up on the frame. Returns the frame's words or
+// NULL if the frame is dropped.
+uint64_t *stream_acquire(stream *S) {
+    pthread_mutex_lock(&S->mutex);
+    if (S->free_count == 0 && S->policy == STREAM_DROP) {
+        S->dropped++;
+        S->current = -1;
+        pthread_mutex_unlock(&S->mutex);
+        return NULL;
+    }
+    if (S->free_count == 0) {
+        struct timespec t1, t2;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        while (S->free_count == 0) {
+            pthread_cond_wait(&S->cv, &S->mutex);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        S->stalls++;
+        S->stall_ns += elapsed_ns(&t1, &t2);
+    }
+    S->current = S->free_frames[--S->free_count];
+    pthread_mutex_unlock(&S->mutex);
+    return S->frames[S->current]->bits;
+}
+
+// The frame acquired for the current snapshot, NULL if it was dropped.
+// Safe to call from every thread once the acquiring thread has passed
+// a barrier.
+uint64_t *stream_frame(stream *S) {
+    return S->current < 0 ? NULL : S->frames[S->current]->bits;
+}
+
+// Queues the filled frame for the writer.
+void stream_submit(stream *S, long generation) {
+    if (S->current < 0) return;
+
+    pthread_mutex_lock(&S->mutex);
+    S->generation[S->current] = generation;
+    S->queue[(S->head + S->queued) % S->size] = S->current;
+    S->queued++;
+    S->current = -1;
+    pthread_cond_broadcast(&S->cv);
+    pthread_mutex_unlock(&S->mutex);
+}
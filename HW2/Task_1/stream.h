@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "bitgrid.h"
+
+#ifndef _STREAM_H
+#define _STREAM_H
+
+#define FRAME_MAGIC "GOLFRAME"
+
+// Every frame in a stream file starts with this header and is
+// followed by payload_size bytes of compressed board. The board is
+// packed like bitgrid::bits and compressed as a sequence of 32-bit
+// little endian control words: a control word n < 2^31 stands for n
+// zero words, n >= 2^31 is followed by n - 2^31 literal words.
+typedef struct {
+    char magic[8];
+    int32_t rows;
+    int32_t cols;
+    uint64_t generation;
+    uint64_t raw_size;
+    uint64_t payload_size;
+} frame_header;
+
+// What to do when every frame buffer is still waiting to be written.
+typedef enum {
+    STREAM_BLOCK,           // make the compute threads wait
+    STREAM_DROP             // skip the frame and count it as dropped
+} stream_policy;
+
+// stream owns a bounded pool of reusable frame buffers and a writer
+// thread. The compute threads fill a free frame every interval
+// generations and queue it; the writer compresses and writes the
+// queued frames in order and puts the buffers back into the pool.
+typedef struct {
+    FILE *out;
+    int interval;
+    stream_policy policy;
+    int size;                   // number of frame buffers
+    bitgrid **frames;
+    long *generation;           // generation held by each frame
+    int *free_frames;           // stack of free frame indices
+    int free_count;
+    int *queue;                 // ring of frames waiting for the writer
+    int head, queued;
+    int current;                // frame being filled, -1 if none
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    long written;
+    long dropped;
+    long stalls;                // times the compute threads had to wait
+    long stall_ns;
+    uint64_t raw_bytes;
+    uint64_t compressed_bytes;
+} stream;
+
+stream *init_stream(FILE *out, int interval, int frames, stream_policy policy, int rows, int cols);
+void finish_stream(stream *S);
+void destroy_stream(stream *S);
+int stream_due(stream *S, long generation);
+uint64_t *stream_acquire(stream *S);
+uint64_t *stream_frame(stream *S);
+void stream_submit(stream *S, long generation);
+
+#endif
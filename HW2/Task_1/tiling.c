@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include "tiling.h"
+
+// Used when the C library cannot tell the cache sizes.
+#define DEFAULT_L1 (32 * 1024)
+#define DEFAULT_L2 (256 * 1024)
+
+static long cache_size(int name, long fallback) {
+    long size = sysconf(name);
+    return size > 0 ? size : fallback;
+}
+
+// Picks the tile shape from the cache sizes. A tile is swept row by
+// row, so its width is chosen for three input rows plus the output
+// row to take up half of L1; its height so that the input and output
+// tile together take up half of L2.
+void default_tile_shape(int *tile_rows, int *tile_cols) {
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    long l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, DEFAULT_L1);
+    long l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, DEFAULT_L2);
+#else
+    long l1 = DEFAULT_L1, l2 = DEFAULT_L2;
+#endif
+    long width = l1 / 2 / (4 * sizeof(int));
+    width = width / 64 * 64;
+    if (width < 64) width = 64;
+
+    long height = l2 / 2 / (2 * width * sizeof(int));
+    if (height < 8) height = 8;
+
+    *tile_cols = (int)width;
+    *tile_rows = (int)height;
+}
+
+// Interleaves the bits of y and x into a Z-order (Morton) index.
+static unsigned long morton(unsigned int y, unsigned int x) {
+    unsigned long z = 0;
+    for (int b = 0; b < 16; b++) {
+        z |= (unsigned long)((x >> b) & 1) << (2 * b);
+        z |= (unsigned long)((y >> b) & 1) << (2 * b + 1);
+    }
+    return z;
+}
+
+typedef struct {
+    unsigned long key;
+    tile t;
+} keyed_tile;
+
+static int compare_keys(const void *a, const void *b) {
+    unsigned long x = ((const keyed_tile *)a)->key, y = ((const keyed_tile *)b)->key;
+    return (x > y) - (x < y);
+}
+
+// Cuts a rows x cols board into tiles of tile_rows x tile_cols (the
+// last row and column of tiles may be smaller), orders them along a
+// Z curve and splits the curve into threads runs of equal area.
+tiling *init_tiling(int rows, int cols, int threads, int tile_rows, int tile_cols) {
+    tiling *T = (tiling *)malloc(sizeof(tiling));
+    int across = (cols + tile_cols - 1) / tile_cols;
+    int down = (rows + tile_rows - 1) / tile_rows;
+
+    T->tile_rows = tile_rows;
+    T->tile_cols = tile_cols;
+    T->count = across * down;
+    T->tiles = malloc(T->count * sizeof(tile));
+    T->first = malloc((threads + 1) * sizeof(int));
+
+    keyed_tile *keyed = malloc(T->count * sizeof(keyed_tile));
+    for (int y = 0; y < down; y++) {
+        for (int x = 0; x < across; x++) {
+            keyed_tile *k = &keyed[y * across + x];
+            k->key = morton(y, x);
+            k->t.r0 = y * tile_rows;
+            k->t.r1 = (y + 1) * tile_rows < rows ? (y + 1) * tile_rows : rows;
+            k->t.c0 = x * tile_cols;
+            k->t.c1 = (x + 1) * tile_cols < cols ? (x + 1) * tile_cols : cols;
+        }
+    }
+    qsort(keyed, T->count, sizeof(keyed_tile), compare_keys);
+
+    // Edge tiles can be smaller, so the runs are balanced by cells
+    // rather than by the number of tiles.
+    long total = (long)rows * cols, done = 0;
+    int t = 0;
+    T->first[0] = 0;
+    for (int i = 0; i < T->count; i++) {
+        T->tiles[i] = keyed[i].t;
+        while (t + 1 < threads && done >= total * (t + 1) / threads) {
+            T->first[++t] = i;
+        }
+        done += (long)(keyed[i].t.r1 - keyed[i].t.r0) * (keyed[i].t.c1 - keyed[i].t.c0);
+    }
+    while (t < threads) {
+        T->first[++t] = T->count;
+    }
+    free(keyed);
+    return T;
+}
+
+void destroy_tiling(tiling *T) {
+    free(T->tiles);
+    free(T->first);
+    free(T);
+}
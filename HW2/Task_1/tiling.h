@@ -0,0 +1,24 @@
+#ifndef _TILING_H
+#define _TILING_H
+
+// A rectangle of the board, rows [r0, r1) and columns [c0, c1).
+typedef struct {
+    int r0, r1;
+    int c0, c1;
+} tile;
+
+// tiling cuts the board into cache-sized tiles and hands every
+// thread a contiguous run of them along a Z-order curve, so each
+// thread gets a compact block of the board rather than a thin band.
+typedef struct {
+    int tile_rows, tile_cols;   // tile shape
+    int count;
+    tile *tiles;                // in Z order
+    int *first;                 // thread t owns tiles [first[t], first[t + 1])
+} tiling;
+
+tiling *init_tiling(int rows, int cols, int threads, int tile_rows, int tile_cols);
+void destroy_tiling(tiling *T);
+void default_tile_shape(int *tile_rows, int *tile_cols);
+
+#endif
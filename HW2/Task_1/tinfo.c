@@ -10,5 +10,18 @@ tinfo *init_tinfo() {
     T->out = NULL;
     T->section = 0;
     T->divide = 0;
+    T->gen = 0;
+    T->start = 0;
+    T->ckpt = NULL;
+    T->frames = NULL;
+    T->cycles = NULL;
+    T->finished = 0;
+    T->stats = NULL;
+    T->stats_out = NULL;
+    T->tiles = NULL;
+    T->edges = NULL;
+    T->past = NULL;
+    T->live = NULL;
+    T->regions = NULL;
     return T;
 }
@@ -1,4 +1,13 @@
+#include <stdio.h>
 #include "grid.h"
+#include "checkpoint.h"
+#include "stream.h"
+#include "cycle.h"
+#include "evolve.h"
+#include "tiling.h"
+#include "history.h"
+#include "live.h"
+#include "sat.h"
 
 #ifndef _TINFO_H
 #define _TINFO_H
@@ -10,12 +19,38 @@
 // integral values: gen holds the number of generations the
 // GoL simulation will run, and section/divide are used
 // to compute the section of the grid G that our thread will
-// work on.
+// work on. start is the generation the board is at when the threads
+// begin, ckpt (if not NULL) receives periodic checkpoints and
+// frames (if not NULL) the streamed intermediate generations. cycles
+// (if not NULL) may end the run early; the generation the thread
+// actually stopped at is left in finished. If stats is not NULL,
+// every thread fills stats[section] while evolving and, if stats_out
+// is not NULL, one of them appends the totals of each generation to
+// it. With tiles set
+// the thread evolves its run of tiles instead of its row section;
+// everything else still works on the row sections. With edges set
+// there is no out grid: the section is evolved in place, and edges
+// holds the first and last row of every section from before the
+// generation. past (if not NULL) records every generation, and live
+// (if not NULL) publishes some of them to shared memory. regions (if
+// not NULL) are counted from a summed-area table of every generation.
 typedef struct {
     grid *in;
     grid *out;
     int section, divide;
     int gen;
+    long start;
+    checkpointer *ckpt;
+    stream *frames;
+    cycle_detector *cycles;
+    long finished;
+    gen_stats *stats;
+    FILE *stats_out;
+    tiling *tiles;
+    int *edges;
+    history *past;
+    live_feed *live;
+    region_set *regions;
 } tinfo;
 
 tinfo *init_tinfo();
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include "transport.h"
+
+// Slots per ring. A worker can only run one generation ahead of its
+// neighbours, so two would do; the rest is slack. A reader waits for
+// its peer without any timeout; if the peer dies, run_processes stops
+// the whole group.
+#define RING_SLOTS 4
+#define CACHE_LINE 64
+
+// ---- shared memory rings ----
+//
+// Every directed link between two neighbours is a single producer,
+// single consumer ring in one POSIX shared memory segment. head and
+// tail only ever grow and live on their own cache lines.
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_ulong head;     // written by the producer
+    _Alignas(CACHE_LINE) atomic_ulong tail;     // written by the consumer
+    _Alignas(CACHE_LINE) char slots[];
+} ring;
+
+typedef struct {
+    char *base;
+    size_t size;
+    size_t ring_size;
+} shm_state;
+
+// Ring 2 * k carries rows from worker k down to worker k + 1,
+// ring 2 * k + 1 carries rows from worker k + 1 up to worker k.
+static ring *ring_at(transport *T, int index) {
+    shm_state *S = T->state;
+    return (ring *)(S->base + index * S->ring_size);
+}
+
+static ring *link_ring(transport *T, int link, int sending) {
+    int k = T->worker;
+    if (link == LINK_DOWN) {
+        return ring_at(T, sending ? 2 * k : 2 * k + 1);
+    }
+    return ring_at(T, sending ? 2 * (k - 1) + 1 : 2 * (k - 1));
+}
+
+// Spins briefly, then lets the peer run; on a busy machine the peer
+// may well be waiting for our core.
+static void backoff(int *spins) {
+    if (++*spins > 64) {
+        sched_yield();
+    }
+}
+
+static transport *shm_create(int workers, size_t row_bytes) {
+    transport *T = calloc(1, sizeof(transport));
+    shm_state *S = calloc(1, sizeof(shm_state));
+    char name[64];
+
+    S->ring_size = sizeof(ring) + RING_SLOTS * ((row_bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+    S->ring_size = (S->ring_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    S->size = S->ring_size * 2 * (workers > 1 ? workers - 1 : 1);
+
+    // The name is unlinked right away, the mapping is inherited by
+    // the forked workers.
+    snprintf(name, sizeof(name), "/gol-halo-%d", (int)getpid());
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        perror("shm_open");
+        free(S);
+        free(T);
+        return NULL;
+    }
+    shm_unlink(name);
+    if (ftruncate(fd, S->size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        free(S);
+        free(T);
+        return NULL;
+    }
+    S->base = mmap(NULL, S->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (S->base == MAP_FAILED) {
+        perror("mmap");
+        free(S);
+        free(T);
+        return NULL;
+    }
+
+    T->state = S;
+    for (int i = 0; i < 2 * (workers - 1); i++) {
+        atomic_init(&ring_at(T, i)->head, 0);
+        atomic_init(&ring_at(T, i)->tail, 0);
+    }
+    return T;
+}
+
+static void shm_attach(transport *T, int worker) {
+    (void)T;
+    (void)worker;
+}
+
+static int shm_send(transport *T, int link, const void *row) {
+    ring *R = link_ring(T, link, 1);
+    size_t slot = (T->row_bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    unsigned long head = atomic_load_explicit(&R->head, memory_order_relaxed);
+    int spins = 0;
+
+    while (head - atomic_load_explicit(&R->tail, memory_order_acquire) == RING_SLOTS) {
+        backoff(&spins);
+    }
+    memcpy(R->slots + (head % RING_SLOTS) * slot, row, T->row_bytes);
+    atomic_store_explicit(&R->head, head + 1, memory_order_release);
+    return 0;
+}
+
+static int shm_recv(transport *T, int link, void *row) {
+    ring *R = link_ring(T, link, 0);
+    size_t slot = (T->row_bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    unsigned long tail = atomic_load_explicit(&R->tail, memory_order_relaxed);
+    int spins = 0;
+
+    while (atomic_load_explicit(&R->head, memory_order_acquire) == tail) {
+        backoff(&spins);
+    }
+    memcpy(row, R->slots + (tail % RING_SLOTS) * slot, T->row_bytes);
+    atomic_store_explicit(&R->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+static void shm_destroy(transport *T) {
+    shm_state *S = T->state;
+    munmap(S->base, S->size);
+    free(S);
+}
+
+// ---- local sockets ----
+//
+// One stream socket pair per pair of neighbours. Over a network the
+// same protocol would run on TCP connections.
+
+typedef struct {
+    int (*pairs)[2];            // pairs[k] links worker k and k + 1
+} socket_state;
+
+static transport *socket_create(int workers, size_t row_bytes) {
+    (void)row_bytes;
+    transport *T = calloc(1, sizeof(transport));
+    socket_state *S = calloc(1, sizeof(socket_state));
+
+    S->pairs = calloc(workers > 1 ? workers - 1 : 1, sizeof(int[2]));
+    for (int k = 0; k + 1 < workers; k++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, S->pairs[k]) != 0) {
+            perror("socketpair");
+            for (int i = 0; i < k; i++) {
+                close(S->pairs[i][0]);
+                close(S->pairs[i][1]);
+            }
+            free(S->pairs);
+            free(S);
+            free(T);
+            return NULL;
+        }
+    }
+    T->state = S;
+    return T;
+}
+
+// A worker keeps only its own ends of its two links.
+static void socket_attach(transport *T, int worker) {
+    socket_state *S = T->state;
+    for (int k = 0; k + 1 < T->workers; k++) {
+        if (k != worker) close(S->pairs[k][0]);
+        if (k + 1 != worker) close(S->pairs[k][1]);
+    }
+}
+
+static int socket_fd(transport *T, int link) {
+    socket_state *S = T->state;
+    return link == LINK_DOWN ? S->pairs[T->worker][0] : S->pairs[T->worker - 1][1];
+}
+
+static int socket_send(transport *T, int link, const void *row) {
+    const char *p = row;
+    size_t n = T->row_bytes;
+    while (n > 0) {
+        ssize_t done = write(socket_fd(T, link), p, n);
+        if (done <= 0) return -1;
+        p += done;
+        n -= done;
+    }
+    return 0;
+}
+
+static int socket_recv(transport *T, int link, void *row) {
+    char *p = row;
+    size_t n = T->row_bytes;
+    while (n > 0) {
+        ssize_t done = read(socket_fd(T, link), p, n);
+        if (done <= 0) return -1;
+        p += done;
+        n -= done;
+    }
+    return 0;
+}
+
+static void socket_destroy(transport *T) {
+    socket_state *S = T->state;
+    if (T->worker < 0) {
+        for (int k = 0; k + 1 < T->workers; k++) {
+            close(S->pairs[k][0]);
+            close(S->pairs[k][1]);
+        }
+    } else {
+        if (T->worker + 1 < T->workers) close(S->pairs[T->worker][0]);
+        if (T->worker > 0) close(S->pairs[T->worker - 1][1]);
+    }
+    free(S->pairs);
+    free(S);
+}
+
+static const transport_ops transports[] = {
+    {"shm", shm_create, shm_attach, shm_send, shm_recv, shm_destroy},
+    {"socket", socket_create, socket_attach, socket_send, socket_recv, socket_destroy},
+};
+
+// Looks a transport up by name, NULL if there is none.
+const transport_ops *find_transport(const char *name) {
+    for (size_t i = 0; i < sizeof(transports) / sizeof(transports[0]); i++) {
+        if (strcmp(transports[i].name, name) == 0) return &transports[i];
+    }
+    return NULL;
+}
+
+// Sets up the links between workers 0 .. workers - 1, where worker k
+// exchanges rows of row_bytes bytes with workers k - 1 and k + 1.
+transport *create_transport(const transport_ops *ops, int workers, size_t row_bytes) {
+    transport *T = ops->create(workers, row_bytes);
+    if (T == NULL) return NULL;
+    T->ops = ops;
+    T->workers = workers;
+    T->worker = -1;
+    T->row_bytes = row_bytes;
+    return T;
+}
+
+// Called in a freshly forked worker before it uses its links.
+void attach_transport(transport *T, int worker) {
+    T->worker = worker;
+    T->ops->attach(T, worker);
+}
+
+int transport_send(transport *T, int link, const void *row) {
+    return T->ops->send(T, link, row);
+}
+
+int transport_recv(transport *T, int link, void *row) {
+    return T->ops->recv(T, link, row);
+}
+
+void destroy_transport(transport *T) {
+    T->ops->destroy(T);
+    free(T);
+}
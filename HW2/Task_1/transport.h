@@ -0,0 +1,43 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef _TRANSPORT_H
+#define _TRANSPORT_H
+
+// Directions of a worker's two links.
+enum {
+    LINK_UP,                    // to the worker owning the rows above
+    LINK_DOWN                   // to the worker owning the rows below
+};
+
+typedef struct transport transport;
+
+// transport moves halo rows between neighbouring worker processes.
+// It is created by the parent for all workers before they are forked;
+// each child then attaches to its own links. New transports only
+// have to provide these operations.
+typedef struct {
+    const char *name;
+    transport *(*create)(int workers, size_t row_bytes);
+    void (*attach)(transport *T, int worker);
+    int (*send)(transport *T, int link, const void *row);
+    int (*recv)(transport *T, int link, void *row);
+    void (*destroy)(transport *T);
+} transport_ops;
+
+struct transport {
+    const transport_ops *ops;
+    int workers;
+    int worker;                 // the attached worker, -1 in the parent
+    size_t row_bytes;
+    void *state;                // transport specific data
+};
+
+const transport_ops *find_transport(const char *name);
+transport *create_transport(const transport_ops *ops, int workers, size_t row_bytes);
+void attach_transport(transport *T, int worker);
+int transport_send(transport *T, int link, const void *row);
+int transport_recv(transport *T, int link, void *row);
+void destroy_transport(transport *T);
+
+#endif
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "tune.h"
+#include "tiling.h"
+#include "engine.h"
+
+#define TUNE_HEADER "Rows;Cols;Threads;Tile rows;Tile cols;Engine;Time\n"
+
+static int add_config(tune_config *configs, int count, int max, int threads,
+                      int tile_rows, int tile_cols, const char *engine) {
+    if (count >= max) return count;
+    configs[count].threads = threads;
+    configs[count].tile_rows = tile_rows;
+    configs[count].tile_cols = tile_cols;
+    snprintf(configs[count].engine, sizeof(configs[count].engine), "%s", engine);
+    configs[count].ns = 0;
+    return count + 1;
+}
+
+// Lists the configurations worth a trial on a board of rows x cols:
+// thread counts that divide rows up to twice the number of processors,
+// each with row bands and three tile shapes around the one picked from
+// the cache sizes, and every engine but the reference one. Returns the
+// number of configurations.
+int tune_candidates(int rows, int cols, tune_config *configs, int max) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int limit = processors > 1 ? 2 * (int)processors : 2;
+    int tile_rows, tile_cols, count = 0;
+
+    default_tile_shape(&tile_rows, &tile_cols);
+    int shapes[3][2] = {
+        {tile_rows, tile_cols},
+        {tile_rows > 16 ? tile_rows / 2 : tile_rows, tile_cols * 2},
+        {tile_rows * 2, tile_cols > 128 ? tile_cols / 2 : tile_cols},
+    };
+
+    for (int threads = 1; threads <= limit && threads <= rows; threads++) {
+        if (rows % threads != 0) continue;
+        count = add_config(configs, count, max, threads, 0, 0, "");
+        // Tiles only change anything on boards larger than one tile.
+        for (int s = 0; s < 3; s++) {
+            if (shapes[s][0] < rows || shapes[s][1] < cols) {
+                count = add_config(configs, count, max, threads, shapes[s][0], shapes[s][1], "");
+            }
+        }
+    }
+    for (int e = 0; engine_at(e); e++) {
+        if (strcmp(engine_at(e)->name, REFERENCE_ENGINE) == 0) continue;
+        count = add_config(configs, count, max, (int)(processors > 0 ? processors : 1), 0, 0,
+                           engine_at(e)->name);
+    }
+    return count;
+}
+
+// Reads one line of the cache into c, returns 0 on success.
+static int parse_line(const char *line, int *rows, int *cols, tune_config *c) {
+    char engine[sizeof(c->engine)];
+
+    if (sscanf(line, "%d;%d;%d;%d;%d;%31[^;];%ld", rows, cols, &c->threads,
+               &c->tile_rows, &c->tile_cols, engine, &c->ns) != 7) {
+        return -1;
+    }
+    snprintf(c->engine, sizeof(c->engine), "%s", strcmp(engine, "-") == 0 ? "" : engine);
+    return 0;
+}
+
+static void write_line(FILE *f, int rows, int cols, const tune_config *c) {
+    fprintf(f, "%d;%d;%d;%d;%d;%s;%ld\n", rows, cols, c->threads, c->tile_rows, c->tile_cols,
+            c->engine[0] ? c->engine : "-", c->ns);
+}
+
+// Loads the trials of a board of rows x cols from the cache at path.
+// Trials of an engine this build does not know are skipped, so the
+// cache can be shared by builds with different engines.
+// Returns their number, 0 if the size was never tuned.
+int load_tuning(const char *path, int rows, int cols, tune_config *configs, int max) {
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int count = 0, r, c;
+
+    if (f == NULL) return 0;
+    while (count < max && fgets(line, sizeof(line), f)) {
+        if (parse_line(line, &r, &c, &configs[count]) != 0 || r != rows || c != cols) {
+            continue;
+        }
+        if (configs[count].engine[0] && find_engine(configs[count].engine) == NULL) {
+            fprintf(stderr, "Skipping a tuned trial of the unknown engine '%s'.\n", configs[count].engine);
+            continue;
+        }
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+// Stores the trials of a board of rows x cols in the cache at path,
+// replacing earlier ones of the same size and keeping all others.
+int save_tuning(const char *path, int rows, int cols, const tune_config *configs, int count) {
+    char tmp[1040], line[256];
+    FILE *in = fopen(path, "r");
+    FILE *out;
+    int r, c;
+    tune_config old;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    out = fopen(tmp, "w");
+    if (out == NULL) {
+        perror(tmp);
+        if (in) fclose(in);
+        return -1;
+    }
+    fputs(TUNE_HEADER, out);
+    if (in) {
+        while (fgets(line, sizeof(line), in)) {
+            if (parse_line(line, &r, &c, &old) == 0 && (r != rows || c != cols)) {
+                write_line(out, r, c, &old);
+            }
+        }
+        fclose(in);
+    }
+    for (int i = 0; i < count; i++) {
+        write_line(out, rows, cols, &configs[i]);
+    }
+    if (fclose(out) != 0 || rename(tmp, path) != 0) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+// Picks the fastest configuration the run can use: only the given
+// engine if engine is not NULL, engines only if allow_engines, tiles
+// only if allow_tiles. NULL if none fits.
+const tune_config *best_config(const tune_config *configs, int count, const char *engine,
+                               int allow_engines, int allow_tiles) {
+    const tune_config *best = NULL;
+
+    for (int i = 0; i < count; i++) {
+        const tune_config *c = &configs[i];
+        if (engine ? strcmp(c->engine, engine) != 0 : (c->engine[0] && !allow_engines)) continue;
+        if (c->tile_rows > 0 && !allow_tiles) continue;
+        if (best == NULL || c->ns < best->ns) best = c;
+    }
+    return best;
+}
@@ -0,0 +1,22 @@
+#ifndef _TUNE_H
+#define _TUNE_H
+
+#define TUNE_MAX_CONFIGS 64
+
+// One way of running a board and how long its trial took. Thread
+// sections use row bands unless a tile shape is given; with an engine
+// the board is run by that engine instead (see engine.h).
+typedef struct {
+    int threads;
+    int tile_rows, tile_cols;   // 0 for row bands
+    char engine[32];            // empty for thread sections
+    long ns;                    // time of the trial generations
+} tune_config;
+
+int tune_candidates(int rows, int cols, tune_config *configs, int max);
+int load_tuning(const char *path, int rows, int cols, tune_config *configs, int max);
+int save_tuning(const char *path, int rows, int cols, const tune_config *configs, int count);
+const tune_config *best_config(const tune_config *configs, int count, const char *engine,
+                               int allow_engines, int allow_tiles);
+
+#endif
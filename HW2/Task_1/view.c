@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "view.h"
+#include "bitgrid.h"
+
+// Characters of the ASCII view from empty to full.
+static const char ramp[] = " .:-=+*#%@";
+
+typedef struct {
+    const view_source *src;
+    tile region;
+    int width, height;
+    int from, to;               // view rows rendered by the thread
+    uint8_t *shade;
+} view_job;
+
+// Live cells among columns [c0, c1) of a packed row.
+static long count_range(const uint64_t *row, int c0, int c1) {
+    long count = 0;
+    int w0 = c0 >> 6, w1 = (c1 - 1) >> 6;
+
+    for (int w = w0; w <= w1; w++) {
+        uint64_t word = row[w];
+        if (w == w0) word &= ~(uint64_t)0 << (c0 & 63);
+        if (w == w1 && (c1 & 63)) word &= ~(uint64_t)0 >> (64 - (c1 & 63));
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+// Whether columns [c0, c1) of a packed row have no live cells.
+static int range_empty(const uint64_t *row, int c0, int c1) {
+    int w0 = c0 >> 6, w1 = (c1 - 1) >> 6;
+
+    for (int w = w0; w <= w1; w++) {
+        if (row[w]) return 0;
+    }
+    return 1;
+}
+
+// Live cells among columns [c0, c1) of a grid row.
+static long count_cells(const int *row, int c0, int c1) {
+    long count = 0;
+
+    for (int c = c0; c < c1; c++) {
+        count += row[c] & 1;
+    }
+    return count;
+}
+
+// The columns [*c0, *c1) of the region under view column x, at least
+// one.
+static void block_cols(const view_job *job, int x, int *c0, int *c1) {
+    int cols = job->region.c1 - job->region.c0;
+
+    *c0 = job->region.c0 + (int)((long)x * cols / job->width);
+    *c1 = job->region.c0 + (int)((long)(x + 1) * cols / job->width);
+    if (*c1 <= *c0) *c1 = *c0 + 1;
+}
+
+// Renders view rows [from, to). Every pixel covers a block of the
+// region; the cells of the block inside the live box are all counted,
+// straight from the source, and the rest are dead. A view row whose
+// blocks miss the box is not read at all.
+static void *view_worker(void *arguments) {
+    view_job *job = (view_job *)arguments;
+    const view_source *src = job->src;
+    const tile *r = &job->region;
+    const tile *live = &src->live;
+    int rows = r->r1 - r->r0;
+    int words = BITGRID_WORDS(src->cols);
+    int lc0 = live->c0 > r->c0 ? live->c0 : r->c0;
+    int lc1 = live->c1 < r->c1 ? live->c1 : r->c1;
+    long *counts = calloc(job->width, sizeof(long));
+    int x0 = 0, x1 = job->width, c0, c1;
+
+    // The view columns whose blocks reach into the live box.
+    while (x0 < x1 && (block_cols(job, x0, &c0, &c1), c1 <= lc0)) x0++;
+    while (x1 > x0 && (block_cols(job, x1 - 1, &c0, &c1), c0 >= lc1)) x1--;
+
+    for (int y = job->from; y < job->to; y++) {
+        int r0 = r->r0 + (int)((long)y * rows / job->height);
+        int r1 = r->r0 + (int)((long)(y + 1) * rows / job->height);
+        if (r1 <= r0) r1 = r0 + 1;
+        int from = r0 > live->r0 ? r0 : live->r0;
+        int to = r1 < live->r1 ? r1 : live->r1;
+
+        memset(counts, 0, job->width * sizeof(long));
+        for (int i = from; i < to && lc0 < lc1; i++) {
+            const uint64_t *packed = src->bits ? src->bits + (size_t)i * words : NULL;
+            if (packed && range_empty(packed, lc0, lc1)) continue;
+            for (int x = x0; x < x1; x++) {
+                block_cols(job, x, &c0, &c1);
+                if (c0 < lc0) c0 = lc0;
+                if (c1 > lc1) c1 = lc1;
+                if (c0 >= c1) continue;
+                counts[x] += packed ? count_range(packed, c0, c1) : count_cells(src->G->val[i], c0, c1);
+            }
+        }
+        for (int x = 0; x < job->width; x++) {
+            block_cols(job, x, &c0, &c1);
+            long cells = (long)(r1 - r0) * (c1 - c0);
+            long level = 255 * counts[x] / cells;
+            job->shade[(size_t)y * job->width + x] = (uint8_t)(counts[x] && level == 0 ? 1 : level);
+        }
+    }
+    free(counts);
+    return NULL;
+}
+
+int parse_view_format(const char *name, view_format *format) {
+    if (strcmp(name, "ascii") == 0) {
+        *format = VIEW_ASCII;
+    } else if (strcmp(name, "pgm") == 0) {
+        *format = VIEW_PGM;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// Fills shade (width x height, row by row) with the density of live
+// cells in region of the source: 0 for an empty block, 255 for a full
+// one, and at least 1 for a block with any live cell. The view rows
+// are split between threads. Only the part of the region inside the
+// source's live box is read, so the work grows with the view and the
+// live area, not with the board.
+void render_view(const view_source *src, tile region, int width, int height, int threads,
+                 uint8_t *shade) {
+    if (threads < 1) threads = 1;
+    if (threads > height) threads = height;
+    view_job jobs[threads];
+    pthread_t ids[threads];
+
+    for (int t = 0; t < threads; t++) {
+        jobs[t].src = src;
+        jobs[t].region = region;
+        jobs[t].width = width;
+        jobs[t].height = height;
+        jobs[t].from = (int)((long)t * height / threads);
+        jobs[t].to = (int)((long)(t + 1) * height / threads);
+        jobs[t].shade = shade;
+    }
+    for (int t = 1; t < threads; t++) {
+        pthread_create(&ids[t], NULL, &view_worker, &jobs[t]);
+    }
+    view_worker(&jobs[0]);
+    for (int t = 1; t < threads; t++) {
+        pthread_join(ids[t], NULL);
+    }
+}
+
+void write_view(FILE *stream, const uint8_t *shade, int width, int height, view_format format,
+                const char *label) {
+    if (format == VIEW_PGM) {
+        fprintf(stream, "P5\n%d %d\n255\n", width, height);
+        uint8_t *row = malloc(width);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                row[x] = 255 - shade[(size_t)y * width + x];
+            }
+            fwrite(row, 1, width, stream);
+        }
+        free(row);
+        return;
+    }
+
+    char *line = malloc(width + 2);
+    fprintf(stream, "%s\n", label);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int level = shade[(size_t)y * width + x];
+            // Any live cell shows, however sparse the block.
+            line[x] = ramp[level == 0 ? 0 : 1 + level * (int)(sizeof(ramp) - 3) / 255];
+        }
+        line[width] = '\n';
+        fwrite(line, 1, width + 1, stream);
+    }
+    free(line);
+}
@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "grid.h"
+#include "tiling.h"
+
+#ifndef _VIEW_H
+#define _VIEW_H
+
+typedef enum {
+    VIEW_ASCII,             // one character per pixel, darker for denser blocks
+    VIEW_PGM                // binary greymap, white for empty blocks
+} view_format;
+
+// The board a view is rendered from: either packed like bitgrid::bits
+// (bits set, G NULL) or a grid (G set, bits NULL). live bounds the
+// cells that may be alive, like the bounding box of gen_stats; only
+// the part of the board inside it is read. It is the whole board when
+// nothing better is known, and empty (r0 >= r1) for an empty board.
+typedef struct {
+    const uint64_t *bits;
+    grid *G;
+    int rows, cols;
+    tile live;
+} view_source;
+
+int parse_view_format(const char *name, view_format *format);
+void render_view(const view_source *src, tile region, int width, int height, int threads,
+                 uint8_t *shade);
+void write_view(FILE *stream, const uint8_t *shade, int width, int height, view_format format,
+                const char *label);
+
+#endif
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <getopt.h>
+#include "live.h"
+#include "view.h"
+
+// Shows the board a Task_1 run publishes with --live in the terminal,
+// redrawn in place. The run is never slowed down by the viewer: a
+// frame that is overwritten while it is copied is just read again.
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options] NAME\n"
+            "  -s, --size WxH        size of the view in characters (default 80x24)\n"
+            "  -i, --interval MS     milliseconds between redraws (default 100)\n"
+            "  -n, --frames N        stop after N redraws (default: when the run ends)\n"
+            "  -h, --help            show this message\n",
+            program);
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+int main(int argc, char **argv) {
+    int width = 80, height = 24, opt;
+    long interval = 100, frames = -1;
+    static struct option long_options[] = {
+        {"size", required_argument, NULL, 's'},
+        {"interval", required_argument, NULL, 'i'},
+        {"frames", required_argument, NULL, 'n'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "s:i:n:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 's':
+                if (sscanf(optarg, "%dx%d", &width, &height) != 2) width = 0;
+                break;
+            case 'i': interval = atol(optarg); break;
+            case 'n': frames = atol(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind + 1 != argc || width < 1 || height < 1 || interval < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    live_reader *R;
+    while ((R = attach_live_feed(argv[optind])) == NULL) {
+        sleep_ms(interval);
+    }
+
+    const live_header *H = R->header;
+    uint64_t *bits = malloc(H->frame_size);
+    uint8_t *shade = malloc((size_t)width * height);
+    view_source src = {bits, NULL, H->rows, H->cols, {0, H->rows, 0, H->cols}};
+    tile region = {0, H->rows, 0, H->cols};
+    char label[128];
+    long generation, shown = -1;
+
+    for (long redraws = 0; frames < 0 || redraws < frames; redraws++) {
+        int closed = atomic_load_explicit(&H->closed, memory_order_acquire);
+        if (read_live_frame(R, bits, &generation) == 0 && generation != shown) {
+            render_view(&src, region, width, height, 1, shade);
+            snprintf(label, sizeof(label), "\033[H\033[2JGeneration %ld of a %d x %d board",
+                     generation, H->rows, H->cols);
+            write_view(stdout, shade, width, height, VIEW_ASCII, label);
+            fflush(stdout);
+            shown = generation;
+        }
+        // The frame read after the run ended is its last one.
+        if (closed) {
+            break;
+        }
+        sleep_ms(interval);
+    }
+
+    free(shade);
+    free(bits);
+    detach_live_feed(R);
+    return 0;
+}